@@ -4,6 +4,9 @@
 #include "memory"
 #include "utility"
 #include "iostream"
+#include "functional"
+
+#include "../TND004Lab2/bloomFilter.h"  //shared with Lab 2 (HashTable::enable_filter), listed in TND004Lab1.cbp
 
 using namespace std;
 
@@ -22,6 +25,16 @@ public:
     bool is_member(const T& val) const;
     void make_empty();
 
+    //Put a Bloom filter in front of is_member, so that most absent values are rejected
+    //without traversing the list. fp_rate is the false positive rate of the filter
+    //The filter is updated by every insertion (the values are hashed with hash<T>)
+    void enable_filter(double fp_rate = 0.01);
+    void disable_filter();
+
+    //Return the Bloom filter, or nullptr if there is none
+    //Its statistics count the traversals saved and the false positives
+    const Bloom_Filter* get_filter() const;
+
     Set& operator=(const Set s);
     Set& operator+=(const Set& s);
     Set& operator*=(const Set& s);
@@ -77,7 +90,9 @@ private:
     };
     shared_ptr<Node> tail;
     shared_ptr<Node> head;
+    unique_ptr<Bloom_Filter> filter;
     void insert(const T& Val);
+    void rebuild_filter(unsigned capacity);
 };
 
 template<typename T>
@@ -113,6 +128,8 @@ Set<T>::Set(const Set& s)
     head = make_shared<Node>(T(), nullptr, weak_ptr<Node>());
     tail = make_shared<Node>(T(), nullptr, head);
     head->next = tail;
+    if(s.filter)
+        enable_filter(s.filter->get_fp_rate());
     shared_ptr<Node> tempPtr = s.head->next;
     while(tempPtr->next)
     {
@@ -127,6 +144,7 @@ Set<T>::Set(Set&& s) noexcept
 
     swap(head, s.head);
     swap(tail, s.tail);
+    swap(filter, s.filter);
 }
 template<typename T>
 Set<T>::~Set()
@@ -140,6 +158,14 @@ void Set<T>::insert(const T& val)
     shared_ptr<Node> tempPtr = tail->prev.lock();
     tail->prev = temp;
     tempPtr->next = temp;
+
+    if(filter)
+    {
+        if(filter->is_full())
+            rebuild_filter(2 * filter->get_capacity());
+        else
+            filter->add(hash<T>()(val));
+    }
 }
 
 template<typename T>
@@ -164,12 +190,16 @@ int Set<T>::cardinality() const
 template<typename T>
 bool Set<T>::is_member(const T& val) const
 {
+    if(filter && !filter->query(hash<T>()(val)))
+        return false;
     shared_ptr<Node> tmp = head->next;
     while(tmp->next){
         if(tmp->value == val)
             return true;
         tmp = tmp->next;
     }
+    if(filter)
+        filter->false_positive();
     return false;
 }
 template<typename T>
@@ -184,16 +214,47 @@ void Set<T>::make_empty()
         }
         tail->prev = head;
     }
+    if(filter)
+        filter->clear();
     return;
 
 }
 
+template<typename T>
+void Set<T>::enable_filter(double fp_rate)
+{
+    filter.reset(new Bloom_Filter(64, fp_rate));
+    rebuild_filter(max(64, 2 * cardinality()));
+}
+template<typename T>
+void Set<T>::disable_filter()
+{
+    filter.reset();
+}
+template<typename T>
+const Bloom_Filter* Set<T>::get_filter() const
+{
+    return filter.get();
+}
+//Size the filter for capacity values and add the values of the set
+template<typename T>
+void Set<T>::rebuild_filter(unsigned capacity)
+{
+    filter->resize(capacity);
+    shared_ptr<Node> tmp = head->next;
+    while(tmp->next){
+        filter->add(hash<T>()(tmp->value));
+        tmp = tmp->next;
+    }
+}
+
 template<typename T>
 Set<T>& Set<T>::operator=(const Set s)
 {
     Set tmp(s);
     swap(head, tmp.head);
     swap(tail, tmp.tail);
+    swap(filter, tmp.filter);
     return *this;
 }
 template<typename T>
@@ -0,0 +1,682 @@
+/*
+  Course: TND004, Lab 1
+  Description: template class BTree_Set represents an ordered set, stored in a B+-tree
+              Same operations as class Set, plus insertion and removal of single values in O(log n) time,
+              ordered traversal through the linked leaves, and range queries
+*/
+
+#ifndef BTREESET_H_INCLUDED
+#define BTREESET_H_INCLUDED
+
+#include <iostream>
+#include <utility>
+#include <algorithm>
+
+using namespace std;
+
+
+//Template class to represent a set of values of type T, in increasing order (operator<)
+//Use it instead of Set when values are inserted and removed one at a time, in any order,
+//between membership tests and ordered traversals
+//
+//The values are stored in the leaves of a B+-tree, linked in increasing order
+//Inner nodes hold separators: the values in children[i] are < keys[i] <= the values in children[i+1]
+//A node takes about NODE_BYTES bytes (default 4 cache lines), thus a search reads O(log n / log B) nodes
+//and scans a few cache lines in each one
+//All leaves but the root have at least LEAF_CAP / 2 values and all inner nodes but the root at least
+//INNER_CAP / 2 keys, except the last leaf: values inserted in increasing order fill the leaves completely
+template <typename T, unsigned NODE_BYTES = 256>
+class BTree_Set
+{
+public:
+
+    //Number of values in a leaf and of keys in an inner node
+    static constexpr unsigned LEAF_CAP = max<size_t>(4, (NODE_BYTES - 16) / sizeof(T));
+    static constexpr unsigned INNER_CAP = max<size_t>(4, (NODE_BYTES - 16) / (sizeof(T) + sizeof(void*)));
+
+    //Constructor to create an empty set
+    BTree_Set()
+        : root(new Leaf), first((Leaf*) root) { }
+
+    //Conversion constructor: create the set {val}
+    BTree_Set(const T& val)
+        : BTree_Set()
+    {
+        insert(val);
+    }
+
+    //Create a set with the n values in array val, repeated values are stored once
+    BTree_Set(const T val[], int n)
+        : BTree_Set()
+    {
+        for(int i = 0; i < n; ++i)
+            insert(val[i]);
+    }
+
+    //The values of s are inserted in increasing order, which fills the leaves
+    BTree_Set(const BTree_Set& s)
+        : BTree_Set()
+    {
+        s.for_each([this](const T& val) { insert(val); });
+    }
+
+    BTree_Set(BTree_Set&& s) noexcept
+        : BTree_Set()
+    {
+        swap(root, s.root);
+        swap(first, s.first);
+        swap(n_values, s.n_values);
+    }
+
+    BTree_Set& operator=(BTree_Set s)
+    {
+        swap(root, s.root);
+        swap(first, s.first);
+        swap(n_values, s.n_values);
+        return *this;
+    }
+
+    ~BTree_Set()
+    {
+        destroy(root);
+    }
+
+
+    //Return true if the set is empty
+    bool _empty() const
+    {
+        return n_values == 0;
+    }
+
+    //Return number of values in the set, O(1)
+    int cardinality() const
+    {
+        return n_values;
+    }
+
+    //Test whether val belongs to the set, O(log n)
+    bool is_member(const T& val) const
+    {
+        const Leaf* leaf = find_leaf(val);
+
+        return binary_search(leaf->values, leaf->values + leaf->n, val);
+    }
+
+    //Remove all values
+    void make_empty()
+    {
+        destroy(root);
+        root = first = new Leaf;
+        n_values = 0;
+    }
+
+    //Insert val, O(log n)
+    //Return false if val was already in the set
+    bool insert(const T& val);
+
+    //Remove val, O(log n)
+    //Return false if val was not in the set
+    bool erase(const T& val);
+
+
+    //Union: add the values of s to this set
+    BTree_Set& operator+=(const BTree_Set& s);
+
+    //Intersection: keep the values also in s
+    BTree_Set& operator*=(const BTree_Set& s);
+
+    //Difference: remove the values in s
+    BTree_Set& operator-=(const BTree_Set& s);
+
+    friend BTree_Set operator+(BTree_Set a, const BTree_Set& b)
+    {
+        a += b;
+        return a;
+    }
+
+    friend BTree_Set operator*(BTree_Set a, const BTree_Set& b)
+    {
+        a *= b;
+        return a;
+    }
+
+    friend BTree_Set operator-(BTree_Set a, const BTree_Set& b)
+    {
+        a -= b;
+        return a;
+    }
+
+
+    //Set comparisons: equality, subset, and strict subset
+    bool operator==(const BTree_Set& s) const
+    {
+        return n_values == s.n_values && *this <= s;
+    }
+
+    bool operator!=(const BTree_Set& s) const
+    {
+        return !(*this == s);
+    }
+
+    bool operator<=(const BTree_Set& s) const;
+
+    bool operator<(const BTree_Set& s) const
+    {
+        return n_values < s.n_values && *this <= s;
+    }
+
+
+    //Call f(val) for every value in the set, in increasing order
+    template <typename Function>
+    void for_each(Function f) const
+    {
+        for(const Leaf* leaf = first; leaf; leaf = leaf->next)
+        {
+            for(unsigned i = 0; i < leaf->n; ++i)
+                f(leaf->values[i]);
+        }
+    }
+
+    //Call f(val) for every value in the set with lo <= val <= hi, in increasing order
+    //O(log n + k) for k values in the range
+    template <typename Function>
+    void range(const T& lo, const T& hi, Function f) const;
+
+
+    //Display the values of s, in increasing order
+    friend ostream& operator<<(ostream& os, const BTree_Set& s)
+    {
+        if(s._empty())
+        {
+            os << "Set is empty!";
+        }
+        else
+        {
+            s.for_each([&os](const T& val) { os << val << " "; });
+        }
+        return os;
+    }
+
+private:
+
+    static constexpr unsigned MIN_LEAF = LEAF_CAP / 2;
+    static constexpr unsigned MIN_INNER = INNER_CAP / 2;
+
+    struct Node
+    {
+        const bool leaf;
+        unsigned n = 0;  //number of values of a leaf, or of keys of an inner node
+
+        explicit Node(bool is_leaf)
+            : leaf(is_leaf) { }
+    };
+
+    struct alignas(64) Leaf : Node
+    {
+        Leaf()
+            : Node(true) { }
+
+        Leaf* next = nullptr;  //leaf with the next values
+        T values[LEAF_CAP];
+    };
+
+    //An inner node with n keys has n + 1 children
+    struct alignas(64) Inner : Node
+    {
+        Inner()
+            : Node(false) { }
+
+        T keys[INNER_CAP];
+        Node* children[INNER_CAP + 1];
+    };
+
+    Node* root;
+    Leaf* first;  //leaf with the smallest values
+    unsigned n_values = 0;
+
+    //Return the leaf where val is, or would be inserted
+    const Leaf* find_leaf(const T& val) const;
+
+    //Insert val in the subtree p, set inserted to false if val is already there
+    //If p is split, return the new node with the upper half of p and set separator to its smallest value
+    Node* insert(Node* p, const T& val, T& separator, bool& inserted);
+
+    //Remove val from the subtree p, return false if it is not there
+    //p may be left with too few values or keys, it is fixed by its parent (see fix_child)
+    bool erase(Node* p, const T& val);
+
+    //Give children[i] of p at least the minimum number of values or keys,
+    //by moving one from a sibling or by merging it with a sibling
+    void fix_child(Inner* p, unsigned i);
+
+    //Merge children[i + 1] of p into children[i]
+    void merge_children(Inner* p, unsigned i);
+
+    static void destroy(Node* p);
+};
+
+
+/* ********************************** *
+* Member functions implementation     *
+* *********************************** */
+
+template <typename T, unsigned NODE_BYTES>
+auto BTree_Set<T, NODE_BYTES>::find_leaf(const T& val) const -> const Leaf*
+{
+    const Node* p = root;
+
+    while(!p->leaf)
+    {
+        const Inner* q = (const Inner*) p;
+
+        p = q->children[upper_bound(q->keys, q->keys + q->n, val) - q->keys];
+    }
+
+    return (const Leaf*) p;
+}
+
+
+//A new root is added when the root is split, thus all leaves stay at the same depth
+template <typename T, unsigned NODE_BYTES>
+bool BTree_Set<T, NODE_BYTES>::insert(const T& val)
+{
+    T separator;
+    bool inserted = true;
+    Node* right = insert(root, val, separator, inserted);
+
+    if(right)
+    {
+        Inner* q = new Inner;
+
+        q->n = 1;
+        q->keys[0] = separator;
+        q->children[0] = root;
+        q->children[1] = right;
+        root = q;
+    }
+
+    n_values += inserted;
+    return inserted;
+}
+
+
+//A full leaf is split in two halves, except the last leaf when val is its largest value:
+//then only val moves to the new leaf, so that values inserted in increasing order fill the leaves
+template <typename T, unsigned NODE_BYTES>
+auto BTree_Set<T, NODE_BYTES>::insert(Node* p, const T& val, T& separator, bool& inserted) -> Node*
+{
+    if(p->leaf)
+    {
+        Leaf* leaf = (Leaf*) p;
+        unsigned i = lower_bound(leaf->values, leaf->values + leaf->n, val) - leaf->values;
+
+        if(i < leaf->n && !(val < leaf->values[i]))
+        {
+            inserted = false;
+            return nullptr;
+        }
+
+        if(leaf->n < LEAF_CAP)
+        {
+            copy_backward(leaf->values + i, leaf->values + leaf->n, leaf->values + leaf->n + 1);
+            leaf->values[i] = val;
+            ++leaf->n;
+            return nullptr;
+        }
+
+        T all[LEAF_CAP + 1];
+
+        copy(leaf->values, leaf->values + i, all);
+        all[i] = val;
+        copy(leaf->values + i, leaf->values + LEAF_CAP, all + i + 1);
+
+        unsigned keep = (i == LEAF_CAP && !leaf->next) ? LEAF_CAP : (LEAF_CAP + 1) / 2;
+        Leaf* right = new Leaf;
+
+        copy(all, all + keep, leaf->values);
+        copy(all + keep, all + LEAF_CAP + 1, right->values);
+        leaf->n = keep;
+        right->n = LEAF_CAP + 1 - keep;
+
+        right->next = leaf->next;
+        leaf->next = right;
+
+        separator = right->values[0];
+        return right;
+    }
+
+    Inner* q = (Inner*) p;
+    unsigned i = upper_bound(q->keys, q->keys + q->n, val) - q->keys;
+    T key;
+    Node* child = insert(q->children[i], val, key, inserted);
+
+    if(!child)
+        return nullptr;
+
+    if(q->n < INNER_CAP)
+    {
+        copy_backward(q->keys + i, q->keys + q->n, q->keys + q->n + 1);
+        copy_backward(q->children + i + 1, q->children + q->n + 1, q->children + q->n + 2);
+        q->keys[i] = key;
+        q->children[i + 1] = child;
+        ++q->n;
+        return nullptr;
+    }
+
+    //split the INNER_CAP + 1 keys, the middle one moves up to the parent
+    T keys[INNER_CAP + 1];
+    Node* children[INNER_CAP + 2];
+
+    copy(q->keys, q->keys + i, keys);
+    keys[i] = key;
+    copy(q->keys + i, q->keys + INNER_CAP, keys + i + 1);
+
+    copy(q->children, q->children + i + 1, children);
+    children[i + 1] = child;
+    copy(q->children + i + 1, q->children + INNER_CAP + 1, children + i + 2);
+
+    const unsigned mid = (INNER_CAP + 1) / 2;
+    Inner* right = new Inner;
+
+    copy(keys, keys + mid, q->keys);
+    copy(children, children + mid + 1, q->children);
+    q->n = mid;
+
+    copy(keys + mid + 1, keys + INNER_CAP + 1, right->keys);
+    copy(children + mid + 1, children + INNER_CAP + 2, right->children);
+    right->n = INNER_CAP - mid;
+
+    separator = keys[mid];
+    return right;
+}
+
+
+//The root is removed when it is an inner node with a single child
+template <typename T, unsigned NODE_BYTES>
+bool BTree_Set<T, NODE_BYTES>::erase(const T& val)
+{
+    if(!erase(root, val))
+        return false;
+
+    if(!root->leaf && root->n == 0)
+    {
+        Inner* q = (Inner*) root;
+
+        root = q->children[0];
+        delete q;
+    }
+
+    --n_values;
+    return true;
+}
+
+
+//Separators are not updated when a leaf loses its smallest value, they still separate the children
+template <typename T, unsigned NODE_BYTES>
+bool BTree_Set<T, NODE_BYTES>::erase(Node* p, const T& val)
+{
+    if(p->leaf)
+    {
+        Leaf* leaf = (Leaf*) p;
+        unsigned i = lower_bound(leaf->values, leaf->values + leaf->n, val) - leaf->values;
+
+        if(i == leaf->n || val < leaf->values[i])
+            return false;
+
+        copy(leaf->values + i + 1, leaf->values + leaf->n, leaf->values + i);
+        --leaf->n;
+        return true;
+    }
+
+    Inner* q = (Inner*) p;
+    unsigned i = upper_bound(q->keys, q->keys + q->n, val) - q->keys;
+
+    if(!erase(q->children[i], val))
+        return false;
+
+    Node* c = q->children[i];
+
+    if(c->n < (c->leaf ? MIN_LEAF : MIN_INNER))
+        fix_child(q, i);
+
+    return true;
+}
+
+
+template <typename T, unsigned NODE_BYTES>
+void BTree_Set<T, NODE_BYTES>::fix_child(Inner* p, unsigned i)
+{
+    Node* left = (i > 0) ? p->children[i - 1] : nullptr;
+    Node* right = (i < p->n) ? p->children[i + 1] : nullptr;
+    const unsigned min_n = p->children[i]->leaf ? MIN_LEAF : MIN_INNER;
+
+    if(left && left->n > min_n)
+    {
+        //move the largest value (key) of the left sibling
+        if(left->leaf)
+        {
+            Leaf* l = (Leaf*) left;
+            Leaf* c = (Leaf*) p->children[i];
+
+            copy_backward(c->values, c->values + c->n, c->values + c->n + 1);
+            c->values[0] = l->values[l->n - 1];
+            p->keys[i - 1] = c->values[0];
+        }
+        else
+        {
+            Inner* l = (Inner*) left;
+            Inner* c = (Inner*) p->children[i];
+
+            copy_backward(c->keys, c->keys + c->n, c->keys + c->n + 1);
+            copy_backward(c->children, c->children + c->n + 1, c->children + c->n + 2);
+            c->keys[0] = p->keys[i - 1];
+            c->children[0] = l->children[l->n];
+            p->keys[i - 1] = l->keys[l->n - 1];
+        }
+
+        --left->n;
+        ++p->children[i]->n;
+    }
+    else if(right && right->n > min_n)
+    {
+        //move the smallest value (key) of the right sibling
+        if(right->leaf)
+        {
+            Leaf* r = (Leaf*) right;
+            Leaf* c = (Leaf*) p->children[i];
+
+            c->values[c->n] = r->values[0];
+            copy(r->values + 1, r->values + r->n, r->values);
+            p->keys[i] = r->values[0];
+        }
+        else
+        {
+            Inner* r = (Inner*) right;
+            Inner* c = (Inner*) p->children[i];
+
+            c->keys[c->n] = p->keys[i];
+            c->children[c->n + 1] = r->children[0];
+            p->keys[i] = r->keys[0];
+            copy(r->keys + 1, r->keys + r->n, r->keys);
+            copy(r->children + 1, r->children + r->n + 1, r->children);
+        }
+
+        --right->n;
+        ++p->children[i]->n;
+    }
+    else
+    {
+        //a sibling has at most the minimum, thus both fit in one node
+        merge_children(p, left ? i - 1 : i);
+    }
+}
+
+
+template <typename T, unsigned NODE_BYTES>
+void BTree_Set<T, NODE_BYTES>::merge_children(Inner* p, unsigned i)
+{
+    Node* left = p->children[i];
+    Node* right = p->children[i + 1];
+
+    if(left->leaf)
+    {
+        Leaf* l = (Leaf*) left;
+        Leaf* r = (Leaf*) right;
+
+        copy(r->values, r->values + r->n, l->values + l->n);
+        l->n += r->n;
+        l->next = r->next;
+        delete r;
+    }
+    else
+    {
+        Inner* l = (Inner*) left;
+        Inner* r = (Inner*) right;
+
+        l->keys[l->n] = p->keys[i];
+        copy(r->keys, r->keys + r->n, l->keys + l->n + 1);
+        copy(r->children, r->children + r->n + 1, l->children + l->n + 1);
+        l->n += 1 + r->n;
+        delete r;
+    }
+
+    copy(p->keys + i + 1, p->keys + p->n, p->keys + i);
+    copy(p->children + i + 2, p->children + p->n + 1, p->children + i + 1);
+    --p->n;
+}
+
+
+template <typename T, unsigned NODE_BYTES>
+void BTree_Set<T, NODE_BYTES>::destroy(Node* p)
+{
+    if(p->leaf)
+    {
+        delete (Leaf*) p;
+        return;
+    }
+
+    Inner* q = (Inner*) p;
+
+    for(unsigned i = 0; i <= q->n; ++i)
+        destroy(q->children[i]);
+
+    delete q;
+}
+
+
+template <typename T, unsigned NODE_BYTES>
+template <typename Function>
+void BTree_Set<T, NODE_BYTES>::range(const T& lo, const T& hi, Function f) const
+{
+    const Leaf* leaf = find_leaf(lo);
+    unsigned i = lower_bound(leaf->values, leaf->values + leaf->n, lo) - leaf->values;
+
+    for(; leaf; leaf = leaf->next, i = 0)
+    {
+        for(; i < leaf->n; ++i)
+        {
+            if(hi < leaf->values[i])
+                return;
+
+            f(leaf->values[i]);
+        }
+    }
+}
+
+
+//The values of s are inserted one by one
+template <typename T, unsigned NODE_BYTES>
+BTree_Set<T, NODE_BYTES>& BTree_Set<T, NODE_BYTES>::operator+=(const BTree_Set& s)
+{
+    if(&s == this)
+        return *this;
+
+    s.for_each([this](const T& val) { insert(val); });
+
+    return *this;
+}
+
+
+//The values of the smaller set found in the larger one are inserted, in increasing order, in a new set
+template <typename T, unsigned NODE_BYTES>
+BTree_Set<T, NODE_BYTES>& BTree_Set<T, NODE_BYTES>::operator*=(const BTree_Set& s)
+{
+    const BTree_Set& smaller = (n_values <= s.n_values) ? *this : s;
+    const BTree_Set& larger = (n_values <= s.n_values) ? s : *this;
+    BTree_Set result;
+
+    smaller.for_each([&](const T& val)
+    {
+        if(larger.is_member(val))
+            result.insert(val);
+    });
+
+    return *this = move(result);
+}
+
+
+//The values of s are removed one by one, unless s is larger than this set:
+//then the values of this set not in s are inserted in a new set
+template <typename T, unsigned NODE_BYTES>
+BTree_Set<T, NODE_BYTES>& BTree_Set<T, NODE_BYTES>::operator-=(const BTree_Set& s)
+{
+    if(&s == this)
+    {
+        make_empty();
+        return *this;
+    }
+
+    if(s.n_values <= n_values)
+    {
+        s.for_each([this](const T& val) { erase(val); });
+        return *this;
+    }
+
+    BTree_Set result;
+
+    for_each([&](const T& val)
+    {
+        if(!s.is_member(val))
+            result.insert(val);
+    });
+
+    return *this = move(result);
+}
+
+
+//Both sets are traversed in increasing order, through their leaves
+template <typename T, unsigned NODE_BYTES>
+bool BTree_Set<T, NODE_BYTES>::operator<=(const BTree_Set& s) const
+{
+    if(n_values > s.n_values)
+        return false;
+
+    const Leaf* leaf = s.first;
+    unsigned j = 0;
+
+    for(const Leaf* p = first; p; p = p->next)
+    {
+        for(unsigned i = 0; i < p->n; ++i)
+        {
+            //next value of s not smaller than p->values[i]
+            while(leaf && (j == leaf->n || leaf->values[j] < p->values[i]))
+            {
+                if(j == leaf->n)
+                {
+                    leaf = leaf->next;
+                    j = 0;
+                }
+                else
+                {
+                    ++j;
+                }
+            }
+
+            if(!leaf || p->values[i] < leaf->values[j])
+                return false;
+        }
+    }
+    return true;
+}
+
+#endif // BTREESET_H_INCLUDED
@@ -0,0 +1,762 @@
+/*
+  Course: TND004, Lab 1
+  Description: template class External_Set represents a set stored in a file, for sets that do not fit in memory
+              Same operations as class Set, the values are kept sorted on disk and read through bounded buffers
+              External_Sorter builds a set from unsorted values with an external merge sort
+*/
+
+#ifndef EXTERNALSET_H_INCLUDED
+#define EXTERNALSET_H_INCLUDED
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <type_traits>
+
+using namespace std;
+
+
+//Number of bytes read or written at a time by a Run_Reader or a Run_Writer
+const size_t RUN_BUFFER = 1 << 20;
+
+//Memory used by an External_Sorter for the values of a run, in bytes (default)
+const size_t SORT_MEMORY = 256 << 20;
+
+//Maximum number of runs merged at once by an External_Sorter, more runs are merged in several passes
+const unsigned MAX_MERGE_RUNS = 128;
+
+
+//Directory where the runs and the results of set operations are created (default: current directory)
+inline string& external_temp_dir()
+{
+    static string dir = ".";
+
+    return dir;
+}
+
+//Return the name of a new temporary file in external_temp_dir()
+inline string external_temp_name()
+{
+    static atomic<unsigned long> counter(0);
+
+    return external_temp_dir() + "/extset_" +
+           to_string(chrono::steady_clock::now().time_since_epoch().count()) + "_" +
+           to_string(counter++) + ".tmp";
+}
+
+
+//Move to the position pos of file f, or return the current position of f
+//Positions have 64 bits, also where long has 32 bits (Windows), since the files can be larger than 2 GB
+//On 32-bit Linux, compile with -D_FILE_OFFSET_BITS=64
+inline int file_seek(FILE* f, uint64_t pos)
+{
+#ifdef _WIN32
+    return _fseeki64(f, (__int64) pos, SEEK_SET);
+#else
+    return fseeko(f, (off_t) pos, SEEK_SET);
+#endif
+}
+
+inline int64_t file_tell(FILE* f)
+{
+#ifdef _WIN32
+    return _ftelli64(f);
+#else
+    return ftello(f);
+#endif
+}
+
+
+/* ********************************** *
+* Runs: files of values               *
+* *********************************** */
+
+//Template class to write the values of a run to a file, one after the other, through a buffer of RUN_BUFFER bytes
+template <typename T>
+class Run_Writer
+{
+public:
+
+    static_assert(is_trivially_copyable<T>::value, "values are written as bytes");
+
+    //Create the file name
+    //Use is_open() to test whether it succeeded
+    explicit Run_Writer(const string& name)
+        : file(fopen(name.c_str(), "wb"))
+    {
+        buffer.reserve(max(RUN_BUFFER / sizeof(T), (size_t) 1));
+    }
+
+    ~Run_Writer()
+    {
+        close();
+    }
+
+    bool is_open() const
+    {
+        return file != nullptr;
+    }
+
+    //Add val at the end of the file
+    void add(const T& val)
+    {
+        buffer.push_back(val);
+        ++n;
+
+        if(buffer.size() == buffer.capacity())
+            flush();
+    }
+
+    //Return number of values added
+    uint64_t size() const
+    {
+        return n;
+    }
+
+    //Close the file, return false if it could not be written
+    bool close()
+    {
+        if(!file)
+            return false;
+
+        flush();
+        ok = (fclose(file) == 0) && ok;
+        file = nullptr;
+
+        return ok;
+    }
+
+private:
+
+    FILE* file;
+    vector<T> buffer;
+    uint64_t n = 0;
+    bool ok = true;
+
+    void flush()
+    {
+        ok = ok && fwrite(buffer.data(), sizeof(T), buffer.size(), file) == buffer.size();
+        buffer.clear();
+    }
+
+    //Disable copy constructor!!
+    Run_Writer(const Run_Writer &) = delete;
+
+    //Disable assignment operator!!
+    const Run_Writer& operator=(const Run_Writer &) = delete;
+};
+
+
+//Template class to read the values of a run from a file, through a buffer of RUN_BUFFER bytes
+//An empty name is an empty run
+template <typename T>
+class Run_Reader
+{
+public:
+
+    static_assert(is_trivially_copyable<T>::value, "values are read as bytes");
+
+    explicit Run_Reader(const string& name)
+        : file(name.empty() ? nullptr : fopen(name.c_str(), "rb"))
+    {
+        buffer.resize(max(RUN_BUFFER / sizeof(T), (size_t) 1));
+    }
+
+    ~Run_Reader()
+    {
+        if(file)
+            fclose(file);
+    }
+
+    //Move to the next value, return false after the last one
+    bool next()
+    {
+        if(++pos < used)
+            return true;
+
+        used = file ? fread(buffer.data(), sizeof(T), buffer.size(), file) : 0;
+        pos = 0;
+
+        return used > 0;
+    }
+
+    //Current value
+    const T& value() const
+    {
+        return buffer[pos];
+    }
+
+private:
+
+    FILE* file;
+    vector<T> buffer;
+    size_t used = 0;  //values in buffer
+    size_t pos = 0;   //current value in buffer
+
+    //Disable copy constructor!!
+    Run_Reader(const Run_Reader &) = delete;
+
+    //Disable assignment operator!!
+    const Run_Reader& operator=(const Run_Reader &) = delete;
+};
+
+
+/* ********************************** *
+* Class External_Set                  *
+* *********************************** */
+
+//Template class to represent a set of values of type T, stored in a file in increasing order
+//without repetitions (the values are written as bytes, thus T must be trivially copyable)
+//Use it instead of Set for sets larger than the memory: an operation reads its operands once,
+//in increasing order, and writes its result to a new file, using O(RUN_BUFFER) memory
+//
+//The result of an operation is stored in a temporary file, removed by the destructor
+//unless the set is saved with save_as()
+template <typename T>
+class External_Set
+{
+public:
+
+    static_assert(is_trivially_copyable<T>::value, "values are stored as bytes");
+
+    //Constructor to create an empty set
+    External_Set() = default;
+
+    //Open the set stored in the file name, e.g. by save_as(), which is not removed by the destructor
+    //Use is_open() to test whether it succeeded
+    explicit External_Set(const string& name);
+
+    //Create a set with the n values in array val, repeated values are stored once
+    External_Set(const T val[], uint64_t n);
+
+    External_Set(External_Set&& s) noexcept
+        : name(move(s.name)), n_values(s.n_values), temporary(s.temporary), valid(s.valid)
+    {
+        s.name.clear();
+        s.n_values = 0;
+        s.temporary = false;
+    }
+
+    External_Set& operator=(External_Set&& s) noexcept
+    {
+        swap(name, s.name);
+        swap(n_values, s.n_values);
+        swap(temporary, s.temporary);
+        swap(valid, s.valid);
+        return *this;
+    }
+
+    ~External_Set()
+    {
+        if(temporary)
+            remove(name.c_str());
+    }
+
+
+    //Return false if the set could not be opened or an operation could not write its result
+    bool is_open() const
+    {
+        return valid;
+    }
+
+    //Return the name of the file, empty for an empty set made by the default constructor
+    const string& get_name() const
+    {
+        return name;
+    }
+
+    //Store the set in the file new_name, which is not removed by the destructor
+    //Return false if the file could not be written
+    bool save_as(const string& new_name);
+
+
+    //Return true if the set is empty
+    bool _empty() const
+    {
+        return n_values == 0;
+    }
+
+    //Return number of values in the set, O(1)
+    uint64_t cardinality() const
+    {
+        return n_values;
+    }
+
+    //Test whether val belongs to the set
+    //Binary search in the file, O(log n) reads
+    bool is_member(const T& val) const;
+
+
+    //Union, intersection, and difference, by merging the two sorted files
+    friend External_Set operator+(const External_Set& a, const External_Set& b)
+    {
+        return merge(a, b, UNION);
+    }
+
+    friend External_Set operator*(const External_Set& a, const External_Set& b)
+    {
+        return merge(a, b, INTERSECTION);
+    }
+
+    friend External_Set operator-(const External_Set& a, const External_Set& b)
+    {
+        return merge(a, b, DIFFERENCE);
+    }
+
+    External_Set& operator+=(const External_Set& s)
+    {
+        return *this = *this + s;
+    }
+
+    External_Set& operator*=(const External_Set& s)
+    {
+        return *this = *this * s;
+    }
+
+    External_Set& operator-=(const External_Set& s)
+    {
+        return *this = *this - s;
+    }
+
+
+    //Set comparisons: equality, subset, and strict subset
+    bool operator==(const External_Set& s) const
+    {
+        return n_values == s.n_values && *this <= s;
+    }
+
+    bool operator!=(const External_Set& s) const
+    {
+        return !(*this == s);
+    }
+
+    bool operator<=(const External_Set& s) const;
+
+    bool operator<(const External_Set& s) const
+    {
+        return n_values < s.n_values && *this <= s;
+    }
+
+
+    //Call f(val) for every value in the set, in increasing order
+    template <typename Function>
+    void for_each(Function f) const
+    {
+        Run_Reader<T> r(name);
+
+        while(r.next())
+            f(r.value());
+    }
+
+
+    //Display the values of s, in increasing order
+    friend ostream& operator<<(ostream& os, const External_Set& s)
+    {
+        if(s._empty())
+        {
+            os << "Set is empty!";
+        }
+        else
+        {
+            s.for_each([&os](const T& val) { os << val << " "; });
+        }
+        return os;
+    }
+
+private:
+
+    enum Operation { UNION, INTERSECTION, DIFFERENCE };
+
+    string name;
+    uint64_t n_values = 0;
+    bool temporary = false;  //the file is removed by the destructor
+    bool valid = true;
+
+    //Result of an operation, written by out to the temporary file file_name
+    External_Set(const string& file_name, Run_Writer<T>& out)
+        : name(file_name), n_values(out.size()), temporary(true)
+    {
+        valid = out.close();
+    }
+
+    //Merge the files of a and b
+    static External_Set merge(const External_Set& a, const External_Set& b, Operation op);
+
+    template <typename U> friend class External_Sorter;
+
+    //Disable copy constructor!!
+    External_Set(const External_Set &) = delete;
+
+    //Disable assignment operator!!
+    const External_Set& operator=(const External_Set &) = delete;
+};
+
+
+/* ********************************** *
+* Class External_Sorter               *
+* *********************************** */
+
+//Template class to build an External_Set from values given in any order (external merge sort)
+//The values are inserted in a buffer of memory bytes; when it is full it is sorted and written
+//to a run file. result() merges the runs, at most MAX_MERGE_RUNS at once, into the set
+//Thus n values are sorted with about n * sizeof(T) / memory runs and O(n log n) comparisons,
+//reading and writing each value once per merge pass
+template <typename T>
+class External_Sorter
+{
+public:
+
+    explicit External_Sorter(size_t memory = SORT_MEMORY)
+        : capacity(max(memory / sizeof(T), (size_t) 1)) { }
+
+    ~External_Sorter()
+    {
+        for(const string& r : runs)
+            remove(r.c_str());
+    }
+
+    //Add val to the set
+    void insert(const T& val)
+    {
+        if(buffer.size() == capacity)
+            write_run();
+
+        buffer.push_back(val);
+    }
+
+    //Return the set of the inserted values, the sorter is then empty
+    External_Set<T> result();
+
+private:
+
+    size_t capacity;  //values in a run
+    vector<T> buffer;
+    vector<string> runs;
+    bool ok = true;
+
+    //Sort the buffer, without repetitions, and write it to a new run
+    void write_run();
+
+    //Merge runs [first, last) into a new run, removing them
+    void merge_runs(unsigned first, unsigned last, Run_Writer<T>& out);
+
+    //Disable copy constructor!!
+    External_Sorter(const External_Sorter &) = delete;
+
+    //Disable assignment operator!!
+    const External_Sorter& operator=(const External_Sorter &) = delete;
+};
+
+
+/* ********************************** *
+* Member functions implementation     *
+* *********************************** */
+
+template <typename T>
+External_Set<T>::External_Set(const string& file_name)
+    : name(file_name)
+{
+    FILE* f = fopen(name.c_str(), "rb");
+
+    valid = f && fseek(f, 0, SEEK_END) == 0;
+
+    if(valid)
+    {
+        int64_t size = file_tell(f);
+
+        valid = size >= 0 && size % sizeof(T) == 0;
+        n_values = valid ? size / sizeof(T) : 0;
+    }
+
+    if(f)
+        fclose(f);
+}
+
+
+template <typename T>
+External_Set<T>::External_Set(const T val[], uint64_t n)
+{
+    External_Sorter<T> sorter;
+
+    for(uint64_t i = 0; i < n; ++i)
+        sorter.insert(val[i]);
+
+    *this = sorter.result();
+}
+
+
+//The temporary file is renamed, otherwise the values are copied
+template <typename T>
+bool External_Set<T>::save_as(const string& new_name)
+{
+    if(!valid)
+        return false;
+
+    if(temporary && rename(name.c_str(), new_name.c_str()) == 0)
+    {
+        name = new_name;
+        temporary = false;
+        return true;
+    }
+
+    Run_Writer<T> out(new_name);
+
+    if(!out.is_open())
+        return false;
+
+    for_each([&out](const T& val) { out.add(val); });
+
+    if(!out.close())
+        return false;
+
+    if(temporary)
+        remove(name.c_str());
+
+    name = new_name;
+    temporary = false;
+    return true;
+}
+
+
+template <typename T>
+bool External_Set<T>::is_member(const T& val) const
+{
+    if(_empty())
+        return false;
+
+    FILE* f = fopen(name.c_str(), "rb");
+
+    if(!f)
+        return false;
+
+    //search the values [low, high)
+    uint64_t low = 0;
+    uint64_t high = n_values;
+    bool found = false;
+
+    while(low < high && !found)
+    {
+        uint64_t mid = low + (high - low) / 2;
+        T x;
+
+        if(file_seek(f, mid * sizeof(T)) != 0 || fread(&x, sizeof(T), 1, f) != 1)
+            break;
+
+        if(x < val)
+            low = mid + 1;
+        else if(val < x)
+            high = mid;
+        else
+            found = true;
+    }
+
+    fclose(f);
+    return found;
+}
+
+
+//Every value of this set is searched in s, both are read once in increasing order
+template <typename T>
+bool External_Set<T>::operator<=(const External_Set& s) const
+{
+    if(n_values > s.n_values)
+        return false;
+
+    Run_Reader<T> a(name);
+    Run_Reader<T> b(s.name);
+    bool more_b = b.next();
+
+    while(a.next())
+    {
+        while(more_b && b.value() < a.value())
+            more_b = b.next();
+
+        if(!more_b || a.value() < b.value())
+            return false;
+    }
+    return true;
+}
+
+
+//Both files are read once in increasing order, the values in the result are written in increasing order
+template <typename T>
+External_Set<T> External_Set<T>::merge(const External_Set& a, const External_Set& b, Operation op)
+{
+    Run_Reader<T> ra(a.name);
+    Run_Reader<T> rb(b.name);
+    string result_name = external_temp_name();
+    Run_Writer<T> out(result_name);
+
+    if(!a.valid || !b.valid || !out.is_open())
+    {
+        External_Set result(result_name, out);
+
+        result.valid = false;
+        return result;
+    }
+
+    bool more_a = ra.next();
+    bool more_b = rb.next();
+
+    while(more_a && more_b)
+    {
+        if(ra.value() < rb.value())
+        {
+            if(op != INTERSECTION)
+                out.add(ra.value());
+            more_a = ra.next();
+        }
+        else if(rb.value() < ra.value())
+        {
+            if(op == UNION)
+                out.add(rb.value());
+            more_b = rb.next();
+        }
+        else
+        {
+            if(op != DIFFERENCE)
+                out.add(ra.value());
+            more_a = ra.next();
+            more_b = rb.next();
+        }
+    }
+
+    for(; more_a && op != INTERSECTION; more_a = ra.next())
+        out.add(ra.value());
+
+    for(; more_b && op == UNION; more_b = rb.next())
+        out.add(rb.value());
+
+    return External_Set(result_name, out);
+}
+
+
+template <typename T>
+void External_Sorter<T>::write_run()
+{
+    if(buffer.empty())
+        return;
+
+    sort(buffer.begin(), buffer.end());
+    buffer.erase(unique(buffer.begin(), buffer.end(),
+                        [](const T& a, const T& b) { return !(a < b) && !(b < a); }),
+                 buffer.end());
+
+    runs.push_back(external_temp_name());
+    Run_Writer<T> out(runs.back());
+
+    if(!out.is_open())
+    {
+        runs.pop_back();
+        ok = false;
+    }
+    else
+    {
+        for(const T& val : buffer)
+            out.add(val);
+
+        ok = out.close() && ok;
+    }
+
+    buffer.clear();
+}
+
+
+//A min-heap holds the current value of each run, equal values are written once
+template <typename T>
+void External_Sorter<T>::merge_runs(unsigned first, unsigned last, Run_Writer<T>& out)
+{
+    vector<unique_ptr<Run_Reader<T> > > readers;
+    vector<Run_Reader<T>*> heap;  //runs with a current value, the smallest one is heap.front()
+
+    for(unsigned i = first; i < last; ++i)
+    {
+        readers.emplace_back(new Run_Reader<T>(runs[i]));
+
+        if(readers.back()->next())
+            heap.push_back(readers.back().get());
+    }
+
+    auto greater_value = [](const Run_Reader<T>* a, const Run_Reader<T>* b)
+    {
+        return b->value() < a->value();
+    };
+
+    make_heap(heap.begin(), heap.end(), greater_value);
+
+    T last_written = T();
+
+    while(!heap.empty())
+    {
+        Run_Reader<T>* r = heap.front();
+
+        if(out.size() == 0 || last_written < r->value())
+        {
+            last_written = r->value();
+            out.add(last_written);
+        }
+
+        pop_heap(heap.begin(), heap.end(), greater_value);
+
+        if(r->next())
+            push_heap(heap.begin(), heap.end(), greater_value);
+        else
+            heap.pop_back();
+    }
+
+    readers.clear();
+
+    for(unsigned i = first; i < last; ++i)
+        remove(runs[i].c_str());
+}
+
+
+//Runs are merged MAX_MERGE_RUNS at a time until at most MAX_MERGE_RUNS are left
+template <typename T>
+External_Set<T> External_Sorter<T>::result()
+{
+    write_run();
+
+    while(runs.size() > MAX_MERGE_RUNS)
+    {
+        string merged = external_temp_name();
+
+        {
+            Run_Writer<T> out(merged);
+
+            if(!out.is_open())
+                break;
+
+            merge_runs(0, MAX_MERGE_RUNS, out);
+            ok = out.close() && ok;
+        }
+
+        runs.erase(runs.begin(), runs.begin() + MAX_MERGE_RUNS);
+        runs.push_back(merged);
+    }
+
+    string result_name = external_temp_name();
+    Run_Writer<T> out(result_name);
+
+    if(out.is_open() && runs.size() <= MAX_MERGE_RUNS)
+    {
+        merge_runs(0, runs.size(), out);
+        runs.clear();
+    }
+
+    External_Set<T> result(result_name, out);
+
+    result.valid = result.valid && ok;
+    ok = true;
+
+    return result;
+}
+
+#endif // EXTERNALSET_H_INCLUDED
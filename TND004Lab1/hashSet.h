@@ -0,0 +1,355 @@
+/*
+  Course: TND004, Lab 1
+  Description: template class Hash_Set represents an unordered set, stored in an open addressing hash table
+              Same operations as class Set, with O(1) average membership tests
+              The probe sequences are the collision resolution policies of Lab 2 (see probing.h)
+*/
+
+#ifndef HASHSET_H_INCLUDED
+#define HASHSET_H_INCLUDED
+
+#include "../TND004Lab2/probing.h"  //shared with Lab 2, listed in TND004Lab1.cbp
+
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <utility>
+#include <algorithm>
+
+using namespace std;
+
+
+//Template class to represent a set of values of type T, without any order
+//Use it instead of Set when the order of the values is not needed, e.g. for membership tests
+//
+//The values are stored in a table with a prime number of slots, searched with the probe sequences of
+//the Probing policy (Linear_Probing, Quadratic_Probing, or Double_Hashing, see probing.h)
+//Each slot caches the hash value of its value, 0 marks an empty slot
+//Hasher is a function object returning the hash value of a value of type T
+template <typename T, typename Hasher = hash<T>, typename Probing = Linear_Probing>
+class Hash_Set
+{
+    static_assert(!Probing::cuckoo, "Hash_Set uses open addressing");
+
+public:
+
+    //The table is re-hashed when its load factor reaches MAX_LOAD
+    static constexpr double MAX_LOAD = (Probing::MAX_LOAD < 0.5) ? Probing::MAX_LOAD : 0.5;
+
+    //Constructor to create an empty set
+    Hash_Set()
+    {
+        allocate(MIN_SLOTS);
+    }
+
+    //Conversion constructor: create the set {val}
+    Hash_Set(const T& val)
+    {
+        allocate(MIN_SLOTS);
+        insert(val);
+    }
+
+    //Create a set with the n values in array val, repeated values are stored once
+    Hash_Set(const T val[], int n)
+    {
+        allocate(slots_for(max(n, 0)));
+
+        for(int i = 0; i < n; ++i)
+            insert(val[i]);
+    }
+
+    //Copy and move
+    Hash_Set(const Hash_Set& s) = default;
+
+    Hash_Set(Hash_Set&& s) noexcept
+        : hashes(move(s.hashes)), values(move(s.values)), n_values(s.n_values)
+    {
+        s.allocate(MIN_SLOTS);
+    }
+
+    Hash_Set& operator=(Hash_Set s)
+    {
+        swap(hashes, s.hashes);
+        swap(values, s.values);
+        swap(n_values, s.n_values);
+        return *this;
+    }
+
+
+    //Return true if the set is empty
+    bool _empty() const
+    {
+        return n_values == 0;
+    }
+
+    //Return number of values in the set, O(1)
+    int cardinality() const
+    {
+        return n_values;
+    }
+
+    //Test whether val belongs to the set, O(1) on average
+    bool is_member(const T& val) const
+    {
+        return find(val, hash_of(val)) != NOT_IN_SET;
+    }
+
+    //Remove all values
+    void make_empty()
+    {
+        allocate(MIN_SLOTS);
+    }
+
+
+    //Union: add the values of s to this set
+    Hash_Set& operator+=(const Hash_Set& s);
+
+    //Intersection: keep the values also in s
+    //The smaller set is iterated and the larger one is searched
+    Hash_Set& operator*=(const Hash_Set& s);
+
+    //Difference: remove the values in s
+    Hash_Set& operator-=(const Hash_Set& s);
+
+    friend Hash_Set operator+(Hash_Set a, const Hash_Set& b)
+    {
+        a += b;
+        return a;
+    }
+
+    friend Hash_Set operator*(Hash_Set a, const Hash_Set& b)
+    {
+        a *= b;
+        return a;
+    }
+
+    friend Hash_Set operator-(Hash_Set a, const Hash_Set& b)
+    {
+        a -= b;
+        return a;
+    }
+
+
+    //Set comparisons: equality, subset, and strict subset
+    bool operator==(const Hash_Set& s) const
+    {
+        return n_values == s.n_values && *this <= s;
+    }
+
+    bool operator!=(const Hash_Set& s) const
+    {
+        return !(*this == s);
+    }
+
+    bool operator<=(const Hash_Set& s) const;
+
+    bool operator<(const Hash_Set& s) const
+    {
+        return n_values < s.n_values && *this <= s;
+    }
+
+
+    //Call f(val) for every value in the set, in slot order
+    template <typename Function>
+    void for_each(Function f) const
+    {
+        for(unsigned i = 0; i < hashes.size(); ++i)
+        {
+            if(hashes[i] != EMPTY)
+                f(values[i]);
+        }
+    }
+
+
+    //Display the values of s, in no particular order
+    friend ostream& operator<<(ostream& os, const Hash_Set& s)
+    {
+        if(s._empty())
+        {
+            os << "Set is empty!";
+        }
+        else
+        {
+            s.for_each([&os](const T& val) { os << val << " "; });
+        }
+        return os;
+    }
+
+private:
+
+    static constexpr size_t EMPTY = 0;
+    static constexpr unsigned NOT_IN_SET = ~0u;
+    static constexpr int MIN_SLOTS = 7;
+
+    //hashes[i] is the hash value of values[i], or EMPTY if slot i is empty
+    vector<size_t> hashes;
+    vector<T> values;
+    unsigned n_values = 0;
+
+    //Return the hash value of val, never EMPTY
+    static size_t hash_of(const T& val)
+    {
+        size_t hv = Hasher()(val);
+
+        return hv + (hv == EMPTY);
+    }
+
+    //Return number of slots needed to store n values below MAX_LOAD
+    static int slots_for(int n)
+    {
+        return (int) (n / MAX_LOAD) + 1;
+    }
+
+    //Create an empty table with at least n_slots slots
+    void allocate(int n_slots)
+    {
+        unsigned size = nextPrime(max(n_slots, (int) Probing::MIN_SIZE));
+
+        hashes.assign(size, EMPTY);
+        values.assign(size, T());
+        n_values = 0;
+    }
+
+    //Return the slot of val, with hash value hv, or NOT_IN_SET
+    unsigned find(const T& val, size_t hv) const
+    {
+        //the table is never full, so the loop stops at an empty slot
+        for(typename Probing::Sequence s(hv, hashes.size()); hashes[*s] != EMPTY; ++s)
+        {
+            if(hashes[*s] == hv && values[*s] == val)
+                return *s;
+        }
+
+        return NOT_IN_SET;
+    }
+
+    //Insert val, with hash value hv, if it is not in the set
+    void insert(const T& val, size_t hv);
+
+    void insert(const T& val)
+    {
+        insert(val, hash_of(val));
+    }
+};
+
+
+/* ********************************** *
+* Member functions implementation     *
+* *********************************** */
+
+//The values of the smaller set are inserted in a copy of the larger one
+template <typename T, typename Hasher, typename Probing>
+Hash_Set<T, Hasher, Probing>& Hash_Set<T, Hasher, Probing>::operator+=(const Hash_Set& s)
+{
+    if(&s == this)
+        return *this;
+
+    if(s.n_values > n_values)
+    {
+        Hash_Set result(s);
+
+        result += *this;
+        return *this = move(result);
+    }
+
+    for(unsigned i = 0; i < s.hashes.size(); ++i)
+    {
+        if(s.hashes[i] != EMPTY)
+            insert(s.values[i], s.hashes[i]);
+    }
+    return *this;
+}
+
+
+//The values of the smaller set found in the larger one are inserted in a new set
+template <typename T, typename Hasher, typename Probing>
+Hash_Set<T, Hasher, Probing>& Hash_Set<T, Hasher, Probing>::operator*=(const Hash_Set& s)
+{
+    const Hash_Set& smaller = (n_values <= s.n_values) ? *this : s;
+    const Hash_Set& larger = (n_values <= s.n_values) ? s : *this;
+    Hash_Set result;
+
+    result.allocate(slots_for(smaller.n_values));
+
+    for(unsigned i = 0; i < smaller.hashes.size(); ++i)
+    {
+        if(smaller.hashes[i] != EMPTY && larger.find(smaller.values[i], smaller.hashes[i]) != NOT_IN_SET)
+            result.insert(smaller.values[i], smaller.hashes[i]);
+    }
+
+    return *this = move(result);
+}
+
+
+//The values of this set not found in s are inserted in a new set
+//Values cannot be removed from the table in place, since their slots may be in other values' probe sequences
+template <typename T, typename Hasher, typename Probing>
+Hash_Set<T, Hasher, Probing>& Hash_Set<T, Hasher, Probing>::operator-=(const Hash_Set& s)
+{
+    if(s._empty())
+        return *this;
+
+    Hash_Set result;
+
+    result.allocate(slots_for(n_values));
+
+    for(unsigned i = 0; i < hashes.size(); ++i)
+    {
+        if(hashes[i] != EMPTY && s.find(values[i], hashes[i]) == NOT_IN_SET)
+            result.insert(values[i], hashes[i]);
+    }
+
+    return *this = move(result);
+}
+
+
+//Every value of this set is searched in s
+template <typename T, typename Hasher, typename Probing>
+bool Hash_Set<T, Hasher, Probing>::operator<=(const Hash_Set& s) const
+{
+    if(n_values > s.n_values)
+        return false;
+
+    for(unsigned i = 0; i < hashes.size(); ++i)
+    {
+        if(hashes[i] != EMPTY && s.find(values[i], hashes[i]) == NOT_IN_SET)
+            return false;
+    }
+    return true;
+}
+
+
+//Re-hash to about twice the size when MAX_LOAD is reached, using the cached hash values
+template <typename T, typename Hasher, typename Probing>
+void Hash_Set<T, Hasher, Probing>::insert(const T& val, size_t hv)
+{
+    typename Probing::Sequence s(hv, hashes.size());
+
+    for(; hashes[*s] != EMPTY; ++s)
+    {
+        if(hashes[*s] == hv && values[*s] == val)
+            return;
+    }
+
+    hashes[*s] = hv;
+    values[*s] = val;
+    ++n_values;
+
+    if(n_values >= MAX_LOAD * hashes.size())
+    {
+        vector<size_t> old_hashes;
+        vector<T> old_values;
+
+        swap(old_hashes, hashes);
+        swap(old_values, values);
+        allocate(2 * old_hashes.size());
+
+        for(unsigned i = 0; i < old_hashes.size(); ++i)
+        {
+            if(old_hashes[i] != EMPTY)
+                insert(old_values[i], old_hashes[i]);
+        }
+    }
+}
+
+#endif // HASHSET_H_INCLUDED
@@ -0,0 +1,193 @@
+/*
+  Course: TND004, Lab 1
+  Description: template class Static_Set represents an immutable ordered set built at compile time
+              from an array of literal values, e.g. a list of keywords
+              The values are stored in a sorted array and searched with a branch-free binary search
+*/
+
+#ifndef STATICSET_H_INCLUDED
+#define STATICSET_H_INCLUDED
+
+#include <iostream>
+#include <cstddef>
+
+using namespace std;
+
+
+//Template class to represent a set of at most N values of type T, in increasing order (operator<)
+//T must be a literal type (e.g. int, char, string_view), thus a set declared constexpr is built by the compiler
+//and needs no initialization at run time:
+//   constexpr int A[] = { 5, 1, 3 };
+//   constexpr Static_Set<int, 3> S(A);
+//   static_assert(S.is_member(3));
+//
+//Same queries as class Set; the operations +, *, - make new Static_Sets, also at compile time
+template <typename T, size_t N>
+class Static_Set
+{
+public:
+
+    //Constructor to create an empty set
+    constexpr Static_Set() = default;
+
+    //Create a set with the N values in array val, repeated values are stored once
+    //The values are sorted by insertion sort, which is fast enough for the small sets built at compile time
+    constexpr explicit Static_Set(const T (&val)[N])
+    {
+        for(size_t i = 0; i < N; ++i)
+            insert(val[i]);
+    }
+
+
+    //Return true if the set is empty
+    constexpr bool _empty() const
+    {
+        return n_values == 0;
+    }
+
+    //Return number of values in the set
+    constexpr int cardinality() const
+    {
+        return n_values;
+    }
+
+    //Test whether val belongs to the set, O(log n)
+    //The search only has the loop branch: each step moves base with a conditional move
+    constexpr bool is_member(const T& val) const
+    {
+        if(n_values == 0)
+            return false;
+
+        const T* base = values;
+
+        for(size_t len = n_values; len > 1; len -= len / 2)
+            base = (base[len / 2] < val) ? base + len / 2 : base;
+
+        //base is the first value not smaller than val, or the last value
+        base += (*base < val);
+
+        return base < values + n_values && !(val < *base);
+    }
+
+
+    //Union, intersection, and difference
+    template <size_t M>
+    constexpr Static_Set<T, N + M> operator+(const Static_Set<T, M>& s) const
+    {
+        Static_Set<T, N + M> result;
+
+        for_each([&result](const T& val) { result.insert(val); });
+        s.for_each([&result](const T& val) { result.insert(val); });
+
+        return result;
+    }
+
+    template <size_t M>
+    constexpr Static_Set<T, N> operator*(const Static_Set<T, M>& s) const
+    {
+        Static_Set<T, N> result;
+
+        for(int i = 0; i < n_values; ++i)
+        {
+            if(s.is_member(values[i]))
+                result.insert(values[i]);
+        }
+
+        return result;
+    }
+
+    template <size_t M>
+    constexpr Static_Set<T, N> operator-(const Static_Set<T, M>& s) const
+    {
+        Static_Set<T, N> result;
+
+        for(int i = 0; i < n_values; ++i)
+        {
+            if(!s.is_member(values[i]))
+                result.insert(values[i]);
+        }
+
+        return result;
+    }
+
+
+    //Set comparisons: equality, subset, and strict subset
+    template <size_t M>
+    constexpr bool operator==(const Static_Set<T, M>& s) const
+    {
+        return n_values == s.cardinality() && *this <= s;
+    }
+
+    template <size_t M>
+    constexpr bool operator!=(const Static_Set<T, M>& s) const
+    {
+        return !(*this == s);
+    }
+
+    template <size_t M>
+    constexpr bool operator<=(const Static_Set<T, M>& s) const
+    {
+        for(int i = 0; i < n_values; ++i)
+        {
+            if(!s.is_member(values[i]))
+                return false;
+        }
+        return true;
+    }
+
+    template <size_t M>
+    constexpr bool operator<(const Static_Set<T, M>& s) const
+    {
+        return n_values < s.cardinality() && *this <= s;
+    }
+
+
+    //Call f(val) for every value in the set, in increasing order
+    template <typename Function>
+    constexpr void for_each(Function f) const
+    {
+        for(int i = 0; i < n_values; ++i)
+            f(values[i]);
+    }
+
+
+    //Display the values of s, in increasing order
+    friend ostream& operator<<(ostream& os, const Static_Set& s)
+    {
+        if(s._empty())
+        {
+            os << "Set is empty!";
+        }
+        else
+        {
+            s.for_each([&os](const T& val) { os << val << " "; });
+        }
+        return os;
+    }
+
+private:
+
+    T values[N > 0 ? N : 1] = { };  //values[0, n_values) in increasing order
+    int n_values = 0;
+
+    //Insert val in order, if it is not in the set
+    constexpr void insert(const T& val)
+    {
+        int i = n_values;
+
+        for(; i > 0 && val < values[i - 1]; --i) { }
+
+        if(i > 0 && !(values[i - 1] < val))
+            return;
+
+        for(int j = n_values; j > i; --j)
+            values[j] = values[j - 1];
+
+        values[i] = val;
+        ++n_values;
+    }
+
+    template <typename U, size_t M> friend class Static_Set;
+};
+
+#endif // STATICSET_H_INCLUDED
@@ -0,0 +1,294 @@
+/*
+  Course: TND004, Lab 1
+  Description: tests of the set classes
+              Each test builds sets with random values, runs the set operations, and compares the results with std::set
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include <algorithm>
+#include <iterator>
+
+#include "Set.h"
+#include "hashSet.h"
+#include "externalSet.h"
+#include "btreeSet.h"
+#include "staticSet.h"
+
+using namespace std;
+
+
+//Display the result of a test, return ok
+bool check(const string& test, bool ok);
+
+template <typename S>
+bool check_set_class(int n);
+
+bool check_external_sort(int n);
+
+template <typename S>
+bool check_btree_updates(int n);
+
+bool check_static_set();
+
+bool check_set_filter(int n);
+
+
+//Test the set classes
+int main()
+{
+    for(int n : { 0, 1, 100, 5000 })
+    {
+        check("Hash_Set, linear probing, " + to_string(n) + " values", check_set_class<Hash_Set<int> >(n));
+        check("Hash_Set, quadratic probing, " + to_string(n) + " values",
+              check_set_class<Hash_Set<int, hash<int>, Quadratic_Probing> >(n));
+        check("Hash_Set, double hashing, " + to_string(n) + " values",
+              check_set_class<Hash_Set<int, hash<int>, Double_Hashing> >(n));
+        check("External_Set, " + to_string(n) + " values", check_set_class<External_Set<int> >(n));
+        check("BTree_Set, " + to_string(n) + " values", check_set_class<BTree_Set<int> >(n));
+        check("BTree_Set, small nodes, " + to_string(n) + " values", check_set_class<BTree_Set<int, 64> >(n));
+    }
+
+    check("External_Set, sorted in several merge passes", check_external_sort(50000));
+    check("BTree_Set, insert, erase, and range", check_btree_updates<BTree_Set<int> >(20000));
+    check("BTree_Set, small nodes, insert, erase, and range", check_btree_updates<BTree_Set<int, 64> >(20000));
+    check("Static_Set", check_static_set());
+
+    for(int n : { 0, 1, 1000 })
+        check("Set with a Bloom filter, " + to_string(n) + " values", check_set_filter(n));
+
+    return 0;
+}
+
+
+//Display the result of a test, return ok
+bool check(const string& test, bool ok)
+{
+    cout << (ok ? "OK      " : "FAILED  ") << test << endl;
+
+    return ok;
+}
+
+
+//Return true if set s has the values in r
+//The values of s are sorted first, since some set classes do not keep them in order
+template <typename S>
+bool same_values(const S& s, const set<int>& r)
+{
+    vector<int> v;
+
+    s.for_each([&v](int x) { v.push_back(x); });
+    sort(v.begin(), v.end());
+
+    return (size_t) s.cardinality() == r.size() && equal(v.begin(), v.end(), r.begin(), r.end());
+}
+
+
+//Build two sets with the set class S from arrays of random values, with repetitions,
+//and compare is_member, union, intersection, difference, and the comparisons with std::set
+template <typename S>
+bool check_set_class(int n)
+{
+    mt19937 gen(1159241 + n);
+    uniform_int_distribution<int> random_value(0, n);
+    vector<int> A(n), B(n / 2);
+
+    generate(A.begin(), A.end(), [&]() { return random_value(gen); });
+    generate(B.begin(), B.end(), [&]() { return random_value(gen); });
+
+    set<int> RA(A.begin(), A.end()), RB(B.begin(), B.end()), U, I, D;
+
+    set_union(RA.begin(), RA.end(), RB.begin(), RB.end(), inserter(U, U.end()));
+    set_intersection(RA.begin(), RA.end(), RB.begin(), RB.end(), inserter(I, I.end()));
+    set_difference(RA.begin(), RA.end(), RB.begin(), RB.end(), inserter(D, D.end()));
+
+    S a(A.data(), n);
+    S b(B.data(), n / 2);
+    bool ok = same_values(a, RA) && same_values(b, RB);
+
+    for(int x = -1; x <= n + 1 && ok; ++x)
+        ok = (a.is_member(x) == (RA.count(x) > 0));
+
+    ok = ok && same_values(a + b, U) && same_values(a * b, I) && same_values(a - b, D);
+
+    ok = ok && a == a && !(a != a) && a <= a && !(a < a);
+    ok = ok && (a * b <= b) && ((a * b < b) == (I.size() < RB.size())) &&
+         ((b <= a) == includes(RA.begin(), RA.end(), RB.begin(), RB.end()));
+    ok = ok && (a - b) + (a * b) == a;
+
+    return ok;
+}
+
+
+//Sort n random values with an External_Sorter holding 64 values per run, thus with more than
+//MAX_MERGE_RUNS runs when n is large, and compare the set with std::set
+bool check_external_sort(int n)
+{
+    mt19937 gen(1159241);
+    uniform_int_distribution<int> random_value(0, n);
+    External_Sorter<int> sorter(64 * sizeof(int));
+    set<int> r;
+
+    for(int i = 0; i < n; ++i)
+    {
+        int x = random_value(gen);
+
+        sorter.insert(x);
+        r.insert(x);
+    }
+
+    External_Set<int> s = sorter.result();
+
+    return s.is_open() && same_values(s, r) && s.is_member(*r.begin()) && !s.is_member(-1);
+}
+
+
+//Insert and erase n random values in a BTree_Set S, in random order, and compare it with std::set
+//after every 1000 operations, together with a range query
+template <typename S>
+bool check_btree_updates(int n)
+{
+    mt19937 gen(1159241);
+    uniform_int_distribution<int> random_value(0, n / 4);
+    S s;
+    set<int> r;
+    bool ok = true;
+
+    for(int i = 1; i <= n && ok; ++i)
+    {
+        int x = random_value(gen);
+
+        //insert twice as often as erase, so that the tree grows and shrinks
+        if(i % 3 != 0)
+            ok = (s.insert(x) == r.insert(x).second);
+        else
+            ok = (s.erase(x) == (r.erase(x) > 0));
+
+        if(i % 1000 == 0 && ok)
+        {
+            int lo = random_value(gen);
+            int hi = lo + n / 16;
+            vector<int> v;
+
+            s.range(lo, hi, [&v](int val) { v.push_back(val); });
+
+            ok = same_values(s, r) && equal(v.begin(), v.end(), r.lower_bound(lo), r.upper_bound(hi));
+        }
+    }
+
+    //erase all values, the tree becomes a single empty leaf
+    for(int x : vector<int>(r.begin(), r.end()))
+        ok = ok && s.erase(x);
+
+    return ok && s._empty() && !s.is_member(0);
+}
+
+
+//Static_Sets built by the compiler: the test fails to compile if a result is wrong
+constexpr int P[] = { 7, 2, 5, 3, 2, 11 };
+constexpr int Q[] = { 5, 4, 3 };
+constexpr Static_Set<int, 6> SP(P);
+constexpr Static_Set<int, 3> SQ(Q);
+
+static_assert(SP.cardinality() == 5 && SP.is_member(2) && SP.is_member(11) && !SP.is_member(4));
+static_assert((SP + SQ).cardinality() == 6 && (SP * SQ).cardinality() == 2 && (SP - SQ).cardinality() == 3);
+static_assert(SP * SQ <= SQ && SP * SQ < SP && !(SP <= SQ) && SP - SQ + SP * SQ == SP);
+
+
+//Static_Sets of N random values built at run time, compared with std::set
+bool check_static_set()
+{
+    const size_t N = 500;
+    mt19937 gen(1159241);
+    uniform_int_distribution<int> random_value(0, N);
+    int A[N], B[N];
+
+    generate(begin(A), end(A), [&]() { return random_value(gen); });
+    generate(begin(B), end(B), [&]() { return random_value(gen); });
+
+    set<int> RA(begin(A), end(A)), RB(begin(B), end(B)), U, I, D;
+
+    set_union(RA.begin(), RA.end(), RB.begin(), RB.end(), inserter(U, U.end()));
+    set_intersection(RA.begin(), RA.end(), RB.begin(), RB.end(), inserter(I, I.end()));
+    set_difference(RA.begin(), RA.end(), RB.begin(), RB.end(), inserter(D, D.end()));
+
+    Static_Set<int, N> a(A), b(B);
+    bool ok = same_values(a, RA) && same_values(b, RB);
+
+    for(int x = -1; x <= (int) N + 1 && ok; ++x)
+        ok = (a.is_member(x) == (RA.count(x) > 0));
+
+    return ok && same_values(a + b, U) && same_values(a * b, I) && same_values(a - b, D) &&
+           (a * b <= a) && (a - b + a * b == a);
+}
+
+
+//Return n sorted values in [0, 4n), without repetitions, as the lists of class Set expect
+vector<int> sorted_values(int n, mt19937& gen)
+{
+    set<int> r;
+    uniform_int_distribution<int> random_value(0, 4 * n);
+
+    while((int) r.size() < n)
+        r.insert(random_value(gen));
+
+    return vector<int>(r.begin(), r.end());
+}
+
+
+//Return true if sets a and b have the same cardinality, and the same answer to is_member for every value in [-1, max]
+bool same_members(const Set<int>& a, const Set<int>& b, int max)
+{
+    bool ok = (a.cardinality() == b.cardinality());
+
+    for(int x = -1; x <= max && ok; ++x)
+        ok = (a.is_member(x) == b.is_member(x));
+
+    return ok;
+}
+
+
+//Compare Set with and without a Bloom filter: is_member, union, intersection, and difference
+//Most absent values must be rejected by the filter
+//Only the compound assignments are used, operators +, *, and - of class Set do not terminate
+bool check_set_filter(int n)
+{
+    mt19937 gen(7919 + n);
+
+    vector<int> A = sorted_values(n, gen);
+    vector<int> B = sorted_values(n, gen);
+
+    Set<int> a(A.data(), n), b(B.data(), n);
+    Set<int> fa(a), fb(b);
+
+    fa.enable_filter();
+    fb.enable_filter();
+
+    bool ok = same_members(a, fa, 4 * n) && same_members(b, fb, 4 * n);
+
+    Set<int> u(a), fu(fa);
+    u += b;
+    fu += fb;
+
+    Set<int> i(a), fi(fa);
+    i *= b;
+    fi *= fb;
+
+    Set<int> d(a), fd(fa);
+    d -= b;
+    fd -= fb;
+
+    ok = ok && same_members(u, fu, 4 * n) && same_members(i, fi, 4 * n) && same_members(d, fd, 4 * n);
+
+    //values inserted after the filter was enabled, more than its initial capacity
+    Set<int> g;
+    g.enable_filter();
+    g += a;
+
+    ok = ok && same_members(a, g, 4 * n);
+
+    return ok && fu.get_filter() && fa.get_filter()->get_stats().rejected > 0;
+}
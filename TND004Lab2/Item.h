@@ -4,27 +4,41 @@
   Description: template class Item and derived class Deleted_Item
 */
 
+#ifndef ITEM_H_INCLUDED
+#define ITEM_H_INCLUDED
+
+#include "arena.h"
+
 #include <iostream>
 #include <iomanip>
 #include <new>
+#include <cstddef>
 
 using namespace std;
 
 
  //Template class to represent an item stored in an hash table
  //item = (key,value)
+ //The key is stored as a Stored_Key (see Key_Storage in arena.h), e.g. string keys are stored as string_views
 template <typename Key_Type, typename Value_Type>
 class Item
 {
 public:
 
-    //Constructor to create an item given a key k and a value v
-    explicit Item(const Key_Type& k, const Value_Type& v)
-        : key(k) , value(v) {  }
+    typedef typename Key_Storage<Key_Type>::type Stored_Key;
+
+    //Constructor to create an item given a key k, a value v,
+    //and the hash value hv of the key
+    explicit Item(const Stored_Key& k, const Value_Type& v, size_t hv = 0)
+        : key(k) , value(v), hash_value(hv) {  }
+
+    //Constructor that takes ownership of the key k
+    explicit Item(Stored_Key&& k, const Value_Type& v, size_t hv = 0)
+        : key(move(k)) , value(v), hash_value(hv) {  }
 
 
     //Return item's key
-    const Key_Type& get_key() const
+    const Stored_Key& get_key() const
     {
         return key;
     }
@@ -36,6 +50,12 @@ public:
         return value;
     }
 
+    //Return the cached hash value of the item's key
+    size_t get_hash() const
+    {
+        return hash_value;
+    }
+
     //Modify the item's value to v
     void set_value(const Value_Type& v)
     {
@@ -45,8 +65,9 @@ public:
 protected:
 
     //data members
-    const Key_Type key;
+    const Stored_Key key;
     Value_Type value;
+    const size_t hash_value;  //full hash value of key, so that it is not re-computed
 
     friend ostream& operator<<(ostream& os, const Item& i)
     {
@@ -70,31 +91,22 @@ class Deleted_Item: public Item<Key_Type,Value_Type>
 public:
 
     //Return pointer to the item used to mark deleted entries in the table
+    //Only one instance of the class is needed to mark deleted slots of the table
+    //It is created by the first call, the initialization of a local static is thread safe
     static Deleted_Item *get_Item()
     {
-        if (!entry)
-        {
-            entry = new Deleted_Item();
-
-            //cout << "Dummy item created!!" << endl;
-        }
+        static Deleted_Item *entry = new Deleted_Item();
 
         return entry;
     }
 
 private:
 
-    //Only one instance of the class is needed to mark deleted slots of the table
-    static Deleted_Item *entry;
-
     //Default constructor
     //Private member function so that only member functions can create class instances
     Deleted_Item()
-        : Item<Key_Type,Value_Type>(Key_Type(), Value_Type()) { }
+        : Item<Key_Type,Value_Type>(typename Item<Key_Type,Value_Type>::Stored_Key(), Value_Type()) { }
 
 };
 
-
-//Initialize static data member (entry)
-template <typename Key_Type, typename Value_Type>
-Deleted_Item<Key_Type,Value_Type> *Deleted_Item<Key_Type,Value_Type>::entry = nullptr;
+#endif // ITEM_H_INCLUDED
@@ -0,0 +1,237 @@
+/*
+  Course: TND004, Lab 2
+  Description: memory arenas used by class HashTable
+              Slab_Allocator allocates objects of one type in large blocks (slabs)
+              String_Arena stores the characters of many strings in large blocks
+              In both cases, the memory is released in bulk when the arena is destroyed
+*/
+
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+
+/* ********************************** *
+* Class Slab_Allocator                *
+* *********************************** */
+
+//Template class to allocate objects of type T in slabs
+//Each slab is twice as large as the previous one, up to MAX_SLAB objects
+//Destroyed objects are kept in a free list and their memory is re-used
+//Note: the destructor only releases the memory, objects still alive are not destroyed
+template <typename T>
+class Slab_Allocator
+{
+public:
+
+    static constexpr size_t MIN_SLAB = 64;
+    static constexpr size_t MAX_SLAB = 64 * 1024;
+
+    Slab_Allocator() = default;
+
+    ~Slab_Allocator()
+    {
+        for (Cell* s : slabs)
+            delete[] s;
+    }
+
+    //Construct a T from args in memory taken from the arena
+    template <typename... Args>
+    T* create(Args&&... args)
+    {
+        Cell* c = free_list;
+
+        if (c)
+        {
+            free_list = c->next;
+        }
+        else
+        {
+            if (used == slab_size)
+                new_slab();
+
+            c = &slabs.back()[used++];
+        }
+
+        return new (c->storage) T(forward<Args>(args)...);
+    }
+
+    //Destroy the object pointed by p and keep its memory for re-use
+    void destroy(T* p)
+    {
+        p->~T();
+
+        Cell* c = reinterpret_cast<Cell*>(p);
+        c->next = free_list;
+        free_list = c;
+    }
+
+    //Return number of memory allocations (slabs) done by the arena
+    unsigned get_count_allocations() const
+    {
+        return slabs.size();
+    }
+
+    //Return number of bytes allocated by the arena
+    size_t memory_usage() const
+    {
+        return total_cells * sizeof(Cell);
+    }
+
+private:
+
+    union Cell
+    {
+        Cell* next;  //next cell in the free list
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    vector<Cell*> slabs;
+    size_t slab_size = 0;    //number of cells in the last slab
+    size_t used = 0;         //number of cells used in the last slab
+    size_t total_cells = 0;
+    Cell* free_list = nullptr;
+
+    void new_slab()
+    {
+        slab_size = (slab_size == 0) ? MIN_SLAB : min(2 * slab_size, MAX_SLAB);
+        slabs.push_back(new Cell[slab_size]);
+        used = 0;
+        total_cells += slab_size;
+    }
+
+    //Disable copy constructor!!
+    Slab_Allocator(const Slab_Allocator &) = delete;
+
+    //Disable assignment operator!!
+    const Slab_Allocator& operator=(const Slab_Allocator &) = delete;
+};
+
+
+/* ********************************** *
+* Class String_Arena                  *
+* *********************************** */
+
+//Class to store the characters of strings in blocks of BLOCK_SIZE bytes
+//Strings larger than a quarter of a block get a block of their own
+//The stored characters are never moved, thus the returned string_views stay valid
+//until the arena is destroyed
+class String_Arena
+{
+public:
+
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    String_Arena() = default;
+
+    ~String_Arena()
+    {
+        for (char* b : blocks)
+            delete[] b;
+    }
+
+    //Copy the characters of s to the arena and return a view of the copy
+    string_view intern(string_view s)
+    {
+        if (s.empty())
+            return string_view();
+
+        char* p;
+
+        if (s.size() > BLOCK_SIZE / 4)
+        {
+            //Insert before the current block, so that its free space is not lost
+            p = new char[s.size()];
+            blocks.insert(blocks.end() - (blocks.empty() ? 0 : 1), p);
+            total_bytes += s.size();
+        }
+        else
+        {
+            if (s.size() > BLOCK_SIZE - used)
+                new_block();
+
+            p = blocks.back() + used;
+            used += s.size();
+        }
+
+        memcpy(p, s.data(), s.size());
+
+        return string_view(p, s.size());
+    }
+
+    //Return number of memory allocations (blocks) done by the arena
+    unsigned get_count_allocations() const
+    {
+        return blocks.size();
+    }
+
+    //Return number of bytes allocated by the arena
+    size_t memory_usage() const
+    {
+        return total_bytes;
+    }
+
+private:
+
+    vector<char*> blocks;
+    size_t used = BLOCK_SIZE;  //number of bytes used in the last block
+    size_t total_bytes = 0;
+
+    void new_block()
+    {
+        blocks.push_back(new char[BLOCK_SIZE]);
+        used = 0;
+        total_bytes += BLOCK_SIZE;
+    }
+
+    //Disable copy constructor!!
+    String_Arena(const String_Arena &) = delete;
+
+    //Disable assignment operator!!
+    const String_Arena& operator=(const String_Arena &) = delete;
+};
+
+
+/* ********************************** *
+* Key storage                         *
+* *********************************** */
+
+//Describe how the keys of a HashTable are stored in its Items
+//By default, Items store a copy of the key
+template <typename Key_Type>
+struct Key_Storage
+{
+    typedef Key_Type type;
+
+    template <typename K>
+    static type store(const K& key, String_Arena&)
+    {
+        return Key_Type(key);
+    }
+};
+
+
+//string keys are interned in the table's String_Arena
+//Items store a string_view of the key's characters, thus no string is allocated per key
+template <>
+struct Key_Storage<string>
+{
+    typedef string_view type;
+
+    static type store(string_view key, String_Arena& arena)
+    {
+        return arena.intern(key);
+    }
+};
+
+#endif // ARENA_H_INCLUDED
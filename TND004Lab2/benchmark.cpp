@@ -0,0 +1,680 @@
+/*
+  Course: TND004, Lab 2
+  Description: benchmark of HashTable, with each collision resolution policy, against std::unordered_map
+              Key streams: the words of text files and synthetic uniform and Zipfian keys
+              Operations: _insert, operator[], _find (hits and misses), _remove, and one re-hash
+              A Concurrent_HashTable is also measured, with operator[] and _find run by several threads
+              Results are written as CSV (default) or JSON
+*/
+
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <thread>
+#include <cmath>
+#include <stdexcept>
+
+#include "hashTable.h"
+#include "concurrentHashTable.h"
+#include "hashers.h"
+#include "tokenizer.h"
+#include "mappedFile.h"
+
+using namespace std;
+
+const unsigned SEED = 1159241;
+
+//Load factors used for both kinds of tables
+const double LOAD_FACTORS[] = { 0.25, 0.5, 0.75, 0.9 };
+
+
+/* ********************************** *
+* Key streams                         *
+* *********************************** */
+
+//A stream of keys: the keys are inserted, searched, and removed in this order
+struct Key_Stream
+{
+    string name;
+    vector<string> keys;    //may contain repeated keys
+    vector<string> misses;  //keys that are not in keys
+};
+
+
+//Return the words of the text file name, normalized as in main.cpp (see Tokenizer)
+Key_Stream file_stream(const string& name);
+
+//Return n keys drawn uniformly from a universe of u distinct keys
+Key_Stream uniform_stream(unsigned n, unsigned u);
+
+//Return n keys drawn from a universe of u distinct keys with a Zipf distribution of exponent s:
+//the key of rank r has probability proportional to 1 / r^s
+Key_Stream zipf_stream(unsigned n, unsigned u, double s);
+
+
+/* ********************************** *
+* Measures                            *
+* *********************************** */
+
+//Result of one operation on one table
+struct Measure
+{
+    string stream;
+    unsigned keys = 0;      //keys in the stream
+    unsigned items = 0;     //keys stored in the table after the operation
+    string table;
+    double max_load = 0;
+    string operation;
+    unsigned long ops = 0;
+    double seconds = 0;
+    double probes_per_op = -1;  //-1: not available
+    double bytes_per_key = 0;   //memory used by the table per stored key
+    double load_factor = 0;     //load factor after the operation
+};
+
+
+//Run all operations of stream S on a HashTable and on an unordered_map with max load factor lf
+//and add the measures to results
+//The HashTable resolves collisions with the policy Probing (see probing.h), name is reported as its table
+//Its max load factor is at most Probing::MAX_LOAD, thus it may be smaller than lf
+//If filter_fp > 0 then the table has a Bloom filter with that false positive rate (see HashTable::enable_filter)
+template <typename Probing>
+void bench_hash_table(const Key_Stream& S, double lf, const string& name, vector<Measure>& results,
+                      double filter_fp = 0);
+void bench_unordered_map(const Key_Stream& S, double lf, vector<Measure>& results);
+
+//Run increment (the thread safe operator[]) and _find hits of stream S on a Concurrent_HashTable
+//shared by n_threads threads, and add the measures to results
+//Each thread runs the operation on a part of the keys, the time is the time until all threads are done
+void bench_concurrent(const Key_Stream& S, unsigned n_threads, vector<Measure>& results);
+
+//Display that the value of an option is not a valid number, and the usage
+//Return the exit status of the program
+int bad_number(const string& value);
+
+//Write the results as CSV or JSON
+void write_csv(ostream& os, const vector<Measure>& results);
+void write_json(ostream& os, const vector<Measure>& results);
+
+
+//Usage: benchmark [-n keys] [-u universe] [-z exponent] [-t threads] [-f csv|json] [-o output] [text files]
+//-n keys: number of keys of the synthetic streams (default 1000000)
+//-u universe: number of distinct keys of the synthetic streams (default 100000)
+//-z exponent: exponent of the Zipf distribution (default 1.0)
+//-t threads: number of threads sharing the Concurrent_HashTable (default one per hardware thread)
+//If no text file is given then the three test files in "Other files" are used
+int main(int argc, char* argv[])
+{
+    unsigned n = 1000000;
+    unsigned u = 100000;
+    double s = 1.0;
+    unsigned n_threads = max(1u, thread::hardware_concurrency());
+    string format = "csv";
+    string out_name;
+    vector<string> names;
+
+    int i = 1;
+
+    try
+    {
+        for (; i < argc; ++i)
+        {
+            string arg = argv[i];
+
+            if (arg == "-n" && i + 1 < argc)
+                n = stoul(argv[++i]);
+            else if (arg == "-u" && i + 1 < argc)
+                u = max(1ul, stoul(argv[++i]));
+            else if (arg == "-z" && i + 1 < argc)
+                s = stod(argv[++i]);
+            else if (arg == "-t" && i + 1 < argc)
+                n_threads = max(1ul, stoul(argv[++i]));
+            else if (arg == "-f" && i + 1 < argc)
+                format = argv[++i];
+            else if (arg == "-o" && i + 1 < argc)
+                out_name = argv[++i];
+            else
+                names.push_back(arg);
+        }
+    }
+    catch (const invalid_argument&)
+    {
+        return bad_number(argv[i]);
+    }
+    catch (const out_of_range&)
+    {
+        return bad_number(argv[i]);
+    }
+
+    if (names.empty())
+    {
+        for (int i = 1; i <= 3; ++i)
+            names.push_back("Other files/test_file" + to_string(i) + ".txt");
+    }
+
+    vector<Key_Stream> streams;
+
+    for (const string& name : names)
+    {
+        streams.push_back(file_stream(name));
+
+        if (streams.back().keys.empty())
+        {
+            cerr << "Could not open a file!! " << name << endl;
+            streams.pop_back();
+        }
+    }
+
+    streams.push_back(uniform_stream(n, u));
+    streams.push_back(zipf_stream(n, u, s));
+
+    vector<Measure> results;
+
+    for (const Key_Stream& S : streams)
+    {
+        for (double lf : LOAD_FACTORS)
+        {
+            cerr << S.name << ", max load factor " << lf << " ..." << endl;
+
+            bench_hash_table<Linear_Probing>(S, lf, "HashTable/linear", results);
+            bench_hash_table<Linear_Probing>(S, lf, "HashTable/linear+bloom", results, 0.01);
+            bench_hash_table<Quadratic_Probing>(S, lf, "HashTable/quadratic", results);
+            bench_hash_table<Double_Hashing>(S, lf, "HashTable/double", results);
+            bench_hash_table<Cuckoo_Hashing<> >(S, lf, "HashTable/cuckoo", results);
+            bench_unordered_map(S, lf, results);
+        }
+
+        cerr << S.name << ", " << n_threads << " threads ..." << endl;
+
+        bench_concurrent(S, n_threads, results);
+    }
+
+    ofstream file_out;
+
+    if (!out_name.empty())
+    {
+        file_out.open(out_name);
+
+        if (!file_out)
+        {
+            cerr << "Could not open a file!!" << endl;
+
+            return 0;
+        }
+    }
+
+    ostream& out = out_name.empty() ? cout : file_out;
+
+    if (format == "json")
+        write_json(out, results);
+    else
+        write_csv(out, results);
+
+    return 0;
+}
+
+
+//Display that the value of an option is not a valid number, and the usage
+int bad_number(const string& value)
+{
+    cerr << "Invalid number: " << value << "!!\n\n"
+         << "Usage: benchmark [-n keys] [-u universe] [-z exponent] [-t threads] [-f csv|json] [-o output] [text files]"
+         << endl;
+
+    return 1;
+}
+
+
+/* ********************************** *
+* Key streams                         *
+* *********************************** */
+
+//Return miss keys: n keys that cannot be words of a stream, since they contain a space
+vector<string> miss_keys(unsigned n)
+{
+    vector<string> v;
+
+    for (unsigned i = 0; i < n; ++i)
+        v.push_back("miss " + to_string(i));
+
+    return v;
+}
+
+
+//Return the words of the text file name
+Key_Stream file_stream(const string& name)
+{
+    Key_Stream S;
+    Mapped_File file(name);
+
+    S.name = name.substr(name.find_last_of("/\\") + 1);
+
+    if (!file.is_open())
+        return S;
+
+    Tokenizer words(file.begin(), file.end());
+    string_view tokens[1024];
+
+    while (unsigned k = words.next_block(tokens, 1024))
+    {
+        for (unsigned i = 0; i < k; ++i)
+            S.keys.emplace_back(tokens[i]);
+    }
+
+    S.misses = miss_keys(S.keys.size());
+
+    return S;
+}
+
+
+//Key of rank r of a synthetic stream
+//The ranks are scrambled, so that frequent keys are not consecutive numbers
+string synthetic_key(unsigned r)
+{
+    return "key" + to_string(r * 2654435761u);
+}
+
+
+//Return n keys drawn uniformly from a universe of u distinct keys
+Key_Stream uniform_stream(unsigned n, unsigned u)
+{
+    Key_Stream S;
+    mt19937 gen(SEED);
+    uniform_int_distribution<unsigned> rank(0, u - 1);
+
+    S.name = "uniform";
+
+    for (unsigned i = 0; i < n; ++i)
+        S.keys.push_back(synthetic_key(rank(gen)));
+
+    S.misses = miss_keys(n);
+
+    return S;
+}
+
+
+//Return n keys drawn from a universe of u distinct keys with a Zipf distribution of exponent s
+//A rank is drawn by binary search of a uniform number in the cumulative distribution
+Key_Stream zipf_stream(unsigned n, unsigned u, double s)
+{
+    Key_Stream S;
+    mt19937 gen(SEED);
+    uniform_real_distribution<double> x(0.0, 1.0);
+    vector<double> cdf(u);
+    double sum = 0;
+
+    for (unsigned r = 0; r < u; ++r)
+    {
+        sum += 1.0 / pow(r + 1.0, s);
+        cdf[r] = sum;
+    }
+
+    S.name = "zipf";
+
+    for (unsigned i = 0; i < n; ++i)
+    {
+        unsigned r = lower_bound(cdf.begin(), cdf.end(), x(gen) * sum) - cdf.begin();
+
+        S.keys.push_back(synthetic_key(min(r, u - 1)));
+    }
+
+    S.misses = miss_keys(n);
+
+    return S;
+}
+
+
+/* ********************************** *
+* Benchmarks                          *
+* *********************************** */
+
+//Return the seconds spent by f()
+template <typename Function>
+double time_of(Function f)
+{
+    auto start = chrono::steady_clock::now();
+
+    f();
+
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
+//The result of the operations is accumulated in sink, so that the compiler does not remove them
+volatile long sink;
+
+
+//HashTable with the same hash function as main.cpp
+template <typename Probing>
+using Bench_Table = HashTable<string, int, wy_hash, equal_to<>, No_Stats, Probing>;
+
+
+//Run all operations of stream S on a HashTable
+template <typename Probing>
+void bench_hash_table(const Key_Stream& S, double lf, const string& name, vector<Measure>& results,
+                      double filter_fp)
+{
+    Bench_Table<Probing> T(100);
+    Bench_Table<Probing> T2(100);  //filled with operator[]
+
+    T.set_max_load_factor(lf);
+    T2.set_max_load_factor(lf);
+
+    if (filter_fp > 0)
+    {
+        T.enable_filter(filter_fp);
+        T2.enable_filter(filter_fp);
+    }
+
+    auto add = [&](const string& op, unsigned long ops, double seconds, const Bench_Table<Probing>& table,
+                   unsigned long visited)
+    {
+        Measure m;
+
+        m.stream = S.name;
+        m.keys = S.keys.size();
+        m.items = table.get_number_OF_items();
+        m.table = name;
+        m.max_load = table.get_max_load_factor();
+        m.operation = op;
+        m.ops = ops;
+        m.seconds = seconds;
+        m.probes_per_op = ops ? (double) visited / ops : 0;
+        m.bytes_per_key = table.get_number_OF_items() ? (double) table.memory_usage() / table.get_number_OF_items() : 0;
+        m.load_factor = table.loadFactor();
+
+        results.push_back(m);
+    };
+
+    unsigned long visited = T.get_total_visited_slots();
+    double t = time_of([&]()
+    {
+        for (unsigned i = 0; i < S.keys.size(); ++i)
+            T._insert(S.keys[i], i);
+    });
+    add("insert", S.keys.size(), t, T, T.get_total_visited_slots() - visited);
+    unsigned distinct = T.get_number_OF_items();
+
+    visited = T2.get_total_visited_slots();
+    t = time_of([&]()
+    {
+        for (const string& key : S.keys)
+            ++T2[key];
+    });
+    add("subscript", S.keys.size(), t, T2, T2.get_total_visited_slots() - visited);
+
+    visited = T.get_total_visited_slots();
+    t = time_of([&]()
+    {
+        long found = 0;
+
+        for (const string& key : S.keys)
+            found += (T._find(key) != nullptr);
+
+        sink = found;
+    });
+    add("find_hit", S.keys.size(), t, T, T.get_total_visited_slots() - visited);
+
+    visited = T.get_total_visited_slots();
+    t = time_of([&]()
+    {
+        long found = 0;
+
+        for (const string& key : S.misses)
+            found += (T._find(key) != nullptr);
+
+        sink = found;
+    });
+    add("find_miss", S.misses.size(), t, T, T.get_total_visited_slots() - visited);
+
+    //time to re-hash the full table to twice its size
+    visited = T.get_total_visited_slots();
+    t = time_of([&]()
+    {
+        T.reserve(2 * distinct);
+    });
+    add("rehash", distinct, t, T, T.get_total_visited_slots() - visited);
+
+    visited = T.get_total_visited_slots();
+    t = time_of([&]()
+    {
+        for (const string& key : S.keys)
+            T._remove(key);
+    });
+    add("remove", S.keys.size(), t, T, T.get_total_visited_slots() - visited);
+}
+
+
+//unordered_map with the same hash function as the HashTable
+typedef unordered_map<string, int, wy_hash> Bench_Map;
+
+
+//Return an estimate of the bytes used by map M: bucket array and one node per key
+//(a node stores the next pointer, the cached hash value, and the pair)
+//Characters of keys too long for the string's own buffer are not counted
+size_t memory_of(const Bench_Map& M)
+{
+    const size_t node = sizeof(void*) + sizeof(size_t) + sizeof(Bench_Map::value_type);
+
+    return M.bucket_count() * sizeof(void*) + M.size() * node;
+}
+
+
+//Run all operations of stream S on an unordered_map
+//Probes per operation are not available: -1 is reported
+void bench_unordered_map(const Key_Stream& S, double lf, vector<Measure>& results)
+{
+    Bench_Map M;
+    Bench_Map M2;  //filled with operator[]
+
+    M.max_load_factor(lf);
+    M2.max_load_factor(lf);
+
+    auto add = [&](const string& op, unsigned long ops, double seconds, const Bench_Map& map)
+    {
+        Measure m;
+
+        m.stream = S.name;
+        m.keys = S.keys.size();
+        m.items = map.size();
+        m.table = "unordered_map";
+        m.max_load = lf;
+        m.operation = op;
+        m.ops = ops;
+        m.seconds = seconds;
+        m.bytes_per_key = map.size() ? (double) memory_of(map) / map.size() : 0;
+        m.load_factor = map.load_factor();
+
+        results.push_back(m);
+    };
+
+    double t = time_of([&]()
+    {
+        for (unsigned i = 0; i < S.keys.size(); ++i)
+            M.insert_or_assign(S.keys[i], i);
+    });
+    add("insert", S.keys.size(), t, M);
+    unsigned distinct = M.size();
+
+    t = time_of([&]()
+    {
+        for (const string& key : S.keys)
+            ++M2[key];
+    });
+    add("subscript", S.keys.size(), t, M2);
+
+    t = time_of([&]()
+    {
+        long found = 0;
+
+        for (const string& key : S.keys)
+            found += (M.find(key) != M.end());
+
+        sink = found;
+    });
+    add("find_hit", S.keys.size(), t, M);
+
+    t = time_of([&]()
+    {
+        long found = 0;
+
+        for (const string& key : S.misses)
+            found += (M.find(key) != M.end());
+
+        sink = found;
+    });
+    add("find_miss", S.misses.size(), t, M);
+
+    t = time_of([&]()
+    {
+        M.reserve(2 * distinct);
+    });
+    add("rehash", distinct, t, M);
+
+    t = time_of([&]()
+    {
+        for (const string& key : S.keys)
+            M.erase(key);
+    });
+    add("remove", S.keys.size(), t, M);
+}
+
+
+//Concurrent_HashTable with the same hash function as the HashTable
+typedef Concurrent_HashTable<string, int, wy_hash> Bench_Shared_Table;
+
+
+//Run all operations of stream S on a Concurrent_HashTable
+//Thread i runs the operation on the keys [n * i / n_threads, n * (i + 1) / n_threads) of the n keys
+void bench_concurrent(const Key_Stream& S, unsigned n_threads, vector<Measure>& results)
+{
+    Bench_Shared_Table T(100);
+    const string name = "Concurrent_HashTable/" + to_string(n_threads) + " threads";
+
+    auto add = [&](const string& op, unsigned long ops, double seconds, unsigned long visited)
+    {
+        Measure m;
+
+        m.stream = S.name;
+        m.keys = S.keys.size();
+        m.items = T.get_number_OF_items();
+        m.table = name;
+        m.max_load = MAX_LOAD_FACTOR;
+        m.operation = op;
+        m.ops = ops;
+        m.seconds = seconds;
+        m.probes_per_op = ops ? (double) visited / ops : 0;
+        m.bytes_per_key = m.items ? (double) T.memory_usage() / m.items : 0;
+        m.load_factor = T.loadFactor();
+
+        results.push_back(m);
+    };
+
+    //run f(i, first, last) in each thread i, for its part [first, last) of the n keys
+    auto run = [n_threads](size_t n, auto f)
+    {
+        vector<thread> workers;
+
+        for (unsigned i = 0; i < n_threads; ++i)
+            workers.emplace_back(f, i, n * i / n_threads, n * (i + 1) / n_threads);
+
+        for (thread& t : workers)
+            t.join();
+    };
+
+    unsigned long visited = T.get_total_visited_slots();
+    double t = time_of([&]()
+    {
+        run(S.keys.size(), [&](unsigned, size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; ++i)
+                T.increment(S.keys[i]);
+        });
+    });
+    add("subscript", S.keys.size(), t, T.get_total_visited_slots() - visited);
+
+    visited = T.get_total_visited_slots();
+    vector<long> found(n_threads, 0);
+    t = time_of([&]()
+    {
+        run(S.keys.size(), [&](unsigned k, size_t first, size_t last)
+        {
+            long n = 0;
+            int v;
+
+            for (size_t i = first; i < last; ++i)
+                n += T._find(S.keys[i], v);
+
+            found[k] = n;
+        });
+    });
+    sink = accumulate(found.begin(), found.end(), 0l);
+    add("find_hit", S.keys.size(), t, T.get_total_visited_slots() - visited);
+}
+
+
+/* ********************************** *
+* Output                              *
+* *********************************** */
+
+//Return the operations per second of m
+double ops_per_second(const Measure& m)
+{
+    return m.seconds > 0 ? m.ops / m.seconds : 0;
+}
+
+
+void write_csv(ostream& os, const vector<Measure>& results)
+{
+    os << "stream,keys,items,table,max_load,operation,ops,seconds,ops_per_sec,probes_per_op,bytes_per_key,load_factor\n";
+
+    for (const Measure& m : results)
+    {
+        os << m.stream << ',' << m.keys << ',' << m.items << ',' << m.table << ','
+           << m.max_load << ',' << m.operation << ',' << m.ops << ',' << m.seconds << ','
+           << (unsigned long) ops_per_second(m) << ',';
+
+        if (m.probes_per_op >= 0)
+            os << m.probes_per_op;
+
+        os << ',' << m.bytes_per_key << ',' << m.load_factor << '\n';
+    }
+}
+
+
+void write_json(ostream& os, const vector<Measure>& results)
+{
+    os << "[\n";
+
+    for (unsigned i = 0; i < results.size(); ++i)
+    {
+        const Measure& m = results[i];
+
+        os << "  { \"stream\": \"" << m.stream << "\", \"keys\": " << m.keys
+           << ", \"items\": " << m.items << ", \"table\": \"" << m.table << "\""
+           << ", \"max_load\": " << m.max_load << ", \"operation\": \"" << m.operation << "\""
+           << ", \"ops\": " << m.ops << ", \"seconds\": " << m.seconds
+           << ", \"ops_per_sec\": " << (unsigned long) ops_per_second(m)
+           << ", \"probes_per_op\": ";
+
+        if (m.probes_per_op >= 0)
+            os << m.probes_per_op;
+        else
+            os << "null";
+
+        os << ", \"bytes_per_key\": " << m.bytes_per_key << ", \"load_factor\": " << m.load_factor
+           << " }" << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+
+    os << "]\n";
+}
@@ -0,0 +1,194 @@
+/*
+  Course: TND004, Lab 2
+  Description: class Bloom_Filter is a blocked Bloom filter of hash values
+              Put in front of a container (HashTable, Set of Lab 1) it rejects most absent keys
+              by reading a single cache line, without searching the container
+*/
+
+#ifndef BLOOMFILTER_H_INCLUDED
+#define BLOOMFILTER_H_INCLUDED
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+using namespace std;
+
+
+//Counters of the queries answered by a Bloom_Filter
+struct Filter_Stats
+{
+    unsigned long queries = 0;          //calls to query()
+    unsigned long rejected = 0;         //keys rejected: searches saved
+    unsigned long false_positives = 0;  //keys accepted that were not in the container
+
+    //Fraction of the accepted absent keys among the absent keys
+    double false_positive_rate() const
+    {
+        unsigned long misses = rejected + false_positives;
+
+        return misses ? (double) false_positives / misses : 0.0;
+    }
+};
+
+
+//Class to represent a set of hash values with false positives but no false negatives
+//The filter is an array of blocks of 512 bits, one cache line each. A hash value selects a block
+//and k bits in it, thus add() and query() touch one cache line (blocked Bloom filter, Putze et al.)
+//
+//The filter is sized for capacity hash values with a false positive rate of about fp_rate
+//Hash values cannot be removed, the container re-builds the filter (see resize) when it is re-hashed
+class Bloom_Filter
+{
+public:
+
+    static constexpr unsigned BLOCK_BITS = 512;
+    static constexpr unsigned MAX_K = 16;
+
+    //Create an empty filter for capacity hash values with a false positive rate fp_rate, 0 < fp_rate < 1
+    Bloom_Filter(unsigned capacity, double fp_rate)
+        : fp_rate(min(max(fp_rate, 1e-6), 0.5))
+    {
+        resize(capacity);
+    }
+
+    //Remove all hash values and size the filter for capacity hash values
+    //The statistics are kept
+    void resize(unsigned capacity)
+    {
+        //A standard Bloom filter needs -ln(p) / ln(2)^2 bits per key and ln(2) * (bits per key) hash functions
+        //A blocked filter has a slightly higher false positive rate, 20% more bits compensate for it
+        const double bits_per_key = 1.2 * -log(fp_rate) / (log(2.0) * log(2.0));
+
+        _capacity = max(capacity, 1u);
+        k = min(MAX_K, max(1u, (unsigned) lround(bits_per_key / 1.2 * log(2.0))));
+        blocks.assign(max(1ul, (unsigned long) ceil(_capacity * bits_per_key / BLOCK_BITS)), Block());
+        n_added = 0;
+    }
+
+    //Remove all hash values
+    void clear()
+    {
+        fill(blocks.begin(), blocks.end(), Block());
+        n_added = 0;
+    }
+
+    //Add hash value hv
+    void add(size_t hv)
+    {
+        Block& b = blocks[block_of(hv)];
+        uint64_t x = bits_of(hv);
+        uint32_t h1 = (uint32_t) x;
+        uint32_t h2 = (uint32_t) (x >> 32) | 1;
+
+        for(unsigned i = 0; i < k; ++i, h1 += h2)
+            b.words[(h1 >> 6) & 7] |= 1ull << (h1 & 63);
+
+        ++n_added;
+    }
+
+    //Return false if hv was never added, true if it may have been added
+    bool may_contain(size_t hv) const
+    {
+        const Block& b = blocks[block_of(hv)];
+        uint64_t x = bits_of(hv);
+        uint32_t h1 = (uint32_t) x;
+        uint32_t h2 = (uint32_t) (x >> 32) | 1;
+
+        for(unsigned i = 0; i < k; ++i, h1 += h2)
+        {
+            if(!(b.words[(h1 >> 6) & 7] & (1ull << (h1 & 63))))
+                return false;
+        }
+        return true;
+    }
+
+    //may_contain(hv), counted in the statistics
+    bool query(size_t hv) const
+    {
+        ++stats.queries;
+
+        if(may_contain(hv))
+            return true;
+
+        ++stats.rejected;
+        return false;
+    }
+
+    //The container did not find a key accepted by query()
+    void false_positive() const
+    {
+        ++stats.false_positives;
+    }
+
+    //Return true if more hash values were added than the filter was sized for
+    bool is_full() const
+    {
+        return n_added >= _capacity;
+    }
+
+    unsigned get_capacity() const
+    {
+        return _capacity;
+    }
+
+    double get_fp_rate() const
+    {
+        return fp_rate;
+    }
+
+    unsigned get_k() const
+    {
+        return k;
+    }
+
+    const Filter_Stats& get_stats() const
+    {
+        return stats;
+    }
+
+    //Return number of bytes used by the bit array
+    size_t memory_usage() const
+    {
+        return blocks.size() * sizeof(Block);
+    }
+
+private:
+
+    struct alignas(64) Block
+    {
+        uint64_t words[BLOCK_BITS / 64] = { };
+    };
+
+    double fp_rate;
+    unsigned _capacity;  //number of hash values the filter is sized for
+    unsigned k;          //bits set per hash value
+    unsigned n_added;    //hash values added since the last resize or clear
+
+    vector<Block> blocks;
+
+    mutable Filter_Stats stats;
+
+    //The block is selected by the high bits of a multiplicative hash of hv
+    unsigned block_of(size_t hv) const
+    {
+        return (unsigned) ((((uint64_t) hv * 0x9e3779b97f4a7c15ull) >> 32) * blocks.size() >> 32);
+    }
+
+    //The bits in the block are selected by the two halves of another mix of hv (double hashing),
+    //hv is mixed again since weak hash functions (e.g. hash<int>) leave the high bits unused
+    static uint64_t bits_of(size_t hv)
+    {
+        uint64_t x = hv;
+
+        x ^= x >> 31;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 29;
+
+        return x;
+    }
+};
+
+#endif // BLOOMFILTER_H_INCLUDED
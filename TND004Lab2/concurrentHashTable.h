@@ -0,0 +1,372 @@
+/*
+  Course: TND004, Lab 2
+  Description: template class Concurrent_HashTable, a hash table that can be used by several threads
+              at the same time (lock striping)
+*/
+
+#ifndef CONCURRENTHASHTABLE_H_INCLUDED
+#define CONCURRENTHASHTABLE_H_INCLUDED
+
+#include "hashTable.h"
+
+#include <iostream>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+
+//Template class to represent a hash table shared by several threads
+//The keys are distributed over a number of shards, each shard is a HashTable protected by its own mutex
+//Thus, threads working on keys in different shards never wait for each other
+//The hash value of a key is computed once: it selects the shard and it is re-used by the shard's table
+//The statistics are kept by each shard (updated under the shard's lock) and added up when read
+template <typename Key_Type, typename Value_Type,
+          typename Hasher = hash<Key_Type>, typename Key_Equal = equal_to<> >
+class Concurrent_HashTable
+{
+    typedef HashTable<Key_Type, Value_Type, Hasher, Key_Equal> Table;
+
+public:
+
+    //Constructor to create a table with n_shards shards (rounded up to a power of two)
+    //table_size is the total initial number of slots, divided among the shards
+    Concurrent_HashTable(int table_size, unsigned n_shards = 64,
+                         const Hasher& f = Hasher(), const Key_Equal& eq = Key_Equal());
+
+
+    //Return the number of shards
+    unsigned get_number_OF_shards() const
+    {
+        return shards.size();
+    }
+
+    //Return number of items stored in the table
+    unsigned get_number_OF_items() const;
+
+    //Return the total number of visited slots, added up over all shards
+    unsigned get_total_visited_slots() const;
+
+    //Return the total number of Items created, added up over all shards
+    unsigned get_count_new_items() const;
+
+    //Return the load factor of the table, i.e. percentage of slots in use or deleted
+    double loadFactor() const;
+
+    //Return number of bytes used by the table, added up over all shards
+    size_t memory_usage() const;
+
+    //Reserve room for n items, i.e. for n / (number of shards) items in each shard
+    //A shard still re-hashes if it receives more keys than its share
+    void reserve(unsigned n);
+
+
+    //Copy the value associated with key to v
+    //If key does not exist in the table then false is returned
+    //Note: a pointer to the value cannot be returned since another thread may modify or remove it
+    template <typename K>
+    bool _find(const K& key, Value_Type& v) const;
+
+    //Insert the Item (key, v) in the table
+    //If key already exists in the table then change the value associated with key to v
+    template <typename K>
+    void _insert(const K& key, const Value_Type& v);
+
+    //Remove Item with key, if the item exists
+    //If an Item was removed then return true
+    template <typename K>
+    bool _remove(const K& key);
+
+    //Call f(value) while holding the lock of key's shard, value is the value associated with key
+    //If key is not in the table then a new Item = (key, Value_Type()) is inserted first
+    //This is the thread safe version of f(T[key])
+    template <typename K, typename Function>
+    void update(const K& key, Function f);
+
+    //Thread safe version of T[key] += by
+    template <typename K>
+    void increment(const K& key, const Value_Type& by = Value_Type(1))
+    {
+        update(key, [&by](Value_Type& v) { v += by; });
+    }
+
+    //++T[keys[i]] for i = 0, ..., n-1
+    //The keys are grouped by shard, so that each shard is locked once per call
+    template <typename K>
+    void increment_many(const K keys[], unsigned n);
+
+
+    //Call f(key, value) for every item in the table
+    //Each shard is locked while its items are visited
+    template <typename Function>
+    void for_each(Function f) const;
+
+
+    //Display all items in table T to stream os
+    friend ostream& operator<<(ostream& os, const Concurrent_HashTable& T)
+    {
+        for (const unique_ptr<Shard>& s : T.shards)
+        {
+            lock_guard<mutex> lock(s->m);
+            os << s->table;
+        }
+
+        return os;
+    }
+
+private:
+
+    //A shard is aligned to a cache line, so that the mutexes of two shards do not share a cache line
+    struct alignas(64) Shard
+    {
+        Shard(int table_size, const Hasher& f, const Key_Equal& eq)
+            : table(table_size, f, eq) { }
+
+        mutable mutex m;
+        Table table;
+    };
+
+    vector<unique_ptr<Shard> > shards;
+    const Hasher h;
+    unsigned shard_bits;  //number of shards is 2^shard_bits
+
+    //Return the shard of a key with hash value hv
+    //Uses the high bits of a multiplicative hash, so that the shard does not depend on the
+    //low bits used by the shard's table to select a slot
+    unsigned shard_of(size_t hv) const
+    {
+        if (shard_bits == 0)
+            return 0;
+
+        return (unsigned) (((uint64_t) hv * 0x9e3779b97f4a7c15ull) >> (64 - shard_bits));
+    }
+
+    //Disable copy constructor!!
+    Concurrent_HashTable(const Concurrent_HashTable &) = delete;
+
+    //Disable assignment operator!!
+    const Concurrent_HashTable& operator=(const Concurrent_HashTable &) = delete;
+};
+
+
+/* ********************************** *
+* Member functions implementation     *
+* *********************************** */
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::Concurrent_HashTable(int table_size,
+                    unsigned n_shards, const Hasher& f, const Key_Equal& eq)
+    : h(f), shard_bits(0)
+{
+    while ((1u << shard_bits) < n_shards)
+        ++shard_bits;
+
+    n_shards = 1u << shard_bits;
+
+    for (unsigned i = 0; i < n_shards; ++i)
+    {
+        shards.emplace_back(new Shard(max(2, table_size / (int) n_shards), f, eq));
+    }
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+unsigned Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::get_number_OF_items() const
+{
+    unsigned n = 0;
+
+    for (const unique_ptr<Shard>& s : shards)
+    {
+        lock_guard<mutex> lock(s->m);
+        n += s->table.get_number_OF_items();
+    }
+
+    return n;
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+unsigned Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::get_total_visited_slots() const
+{
+    unsigned n = 0;
+
+    for (const unique_ptr<Shard>& s : shards)
+    {
+        lock_guard<mutex> lock(s->m);
+        n += s->table.get_total_visited_slots();
+    }
+
+    return n;
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+unsigned Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::get_count_new_items() const
+{
+    unsigned n = 0;
+
+    for (const unique_ptr<Shard>& s : shards)
+    {
+        lock_guard<mutex> lock(s->m);
+        n += s->table.get_count_new_items();
+    }
+
+    return n;
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+size_t Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::memory_usage() const
+{
+    size_t n = 0;
+
+    for (const unique_ptr<Shard>& s : shards)
+    {
+        lock_guard<mutex> lock(s->m);
+        n += s->table.memory_usage();
+    }
+
+    return n;
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+void Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::reserve(unsigned n)
+{
+    const unsigned share = (n + shards.size() - 1) / shards.size();
+
+    for (const unique_ptr<Shard>& s : shards)
+    {
+        lock_guard<mutex> lock(s->m);
+        s->table.reserve(share);
+    }
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+double Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::loadFactor() const
+{
+    double used = 0, slots = 0;
+
+    for (const unique_ptr<Shard>& s : shards)
+    {
+        lock_guard<mutex> lock(s->m);
+        used += s->table.nItems + s->table.nDeleted;
+        slots += s->table._size;
+    }
+
+    return used / slots;
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+template <typename K>
+bool Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::_find(const K& key, Value_Type& v) const
+{
+    size_t hv = h(key);
+    Shard& s = *shards[shard_of(hv)];
+    lock_guard<mutex> lock(s.m);
+
+    const Value_Type* p = s.table.find_hashed(key, hv);
+
+    if (!p)
+        return false;
+
+    v = *p;
+    return true;
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+template <typename K>
+void Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::_insert(const K& key, const Value_Type& v)
+{
+    size_t hv = h(key);
+    Shard& s = *shards[shard_of(hv)];
+    lock_guard<mutex> lock(s.m);
+
+    s.table.insert_hashed(key, v, hv);
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+template <typename K>
+bool Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::_remove(const K& key)
+{
+    size_t hv = h(key);
+    Shard& s = *shards[shard_of(hv)];
+    lock_guard<mutex> lock(s.m);
+
+    return s.table.remove_hashed(key, hv);
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+template <typename K, typename Function>
+void Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::update(const K& key, Function f)
+{
+    size_t hv = h(key);
+    Shard& s = *shards[shard_of(hv)];
+    lock_guard<mutex> lock(s.m);
+
+    f(s.table.subscript_hashed(key, hv));
+}
+
+
+//The keys are distributed over the shards by a counting sort of their indexes
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+template <typename K>
+void Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::increment_many(const K keys[], unsigned n)
+{
+    const unsigned n_shards = shards.size();
+    vector<size_t> hv(n);
+    vector<unsigned> shard(n);
+    vector<unsigned> start(n_shards + 1, 0);
+    vector<unsigned> order(n);
+
+    for (unsigned i = 0; i < n; ++i)
+    {
+        hv[i] = h(keys[i]);
+        shard[i] = shard_of(hv[i]);
+        ++start[shard[i] + 1];
+    }
+
+    for (unsigned i = 0; i < n_shards; ++i)
+        start[i + 1] += start[i];
+
+    vector<unsigned> next(start.begin(), start.end() - 1);
+
+    for (unsigned i = 0; i < n; ++i)
+        order[next[shard[i]]++] = i;
+
+    for (unsigned i = 0; i < n_shards; ++i)
+    {
+        if (start[i] == start[i + 1])
+            continue;
+
+        Shard& s = *shards[i];
+        lock_guard<mutex> lock(s.m);
+
+        for (unsigned j = start[i]; j < start[i + 1]; ++j)
+        {
+            unsigned k = order[j];
+            ++s.table.subscript_hashed(keys[k], hv[k]);
+        }
+    }
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+template <typename Function>
+void Concurrent_HashTable<Key_Type, Value_Type, Hasher, Key_Equal>::for_each(Function f) const
+{
+    for (const unique_ptr<Shard>& s : shards)
+    {
+        lock_guard<mutex> lock(s->m);
+        s->table.for_each(f);
+    }
+}
+
+#endif // CONCURRENTHASHTABLE_H_INCLUDED
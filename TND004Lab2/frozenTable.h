@@ -0,0 +1,366 @@
+/*
+  Course: TND004, Lab 2
+  Description: template class Frozen_Table is an immutable dictionary built from a populated HashTable
+              Keys are placed with a minimal perfect hash function (hash and displace, as PTHash),
+              thus a search reads a single slot
+*/
+
+#ifndef FROZENTABLE_H_INCLUDED
+#define FROZENTABLE_H_INCLUDED
+
+#include "hashTable.h"
+#include "hashers.h"
+#include "arena.h"
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+using namespace std;
+
+
+//Template class to represent an immutable table of n items stored in n slots
+//The keys are split in buckets of about BUCKET_SIZE keys. Each bucket has a pilot, chosen when
+//the table is built, such that the keys of all buckets are sent to different slots:
+//   slot(key) = mix(pos_hash(key), pilot[bucket(key)]) % n
+//Buckets are placed from the largest to the smallest, each one with the first pilot that works
+//If no seed in [0, MAX_SEEDS) gives a pilot to every bucket, all keys are stored in the overflow array
+//
+//The hash values are the ones cached in the HashTable's Items, thus keys are not re-hashed when freezing
+//Hasher should be a good hash function (e.g. wy_hash): keys with the same hash value cannot be
+//separated by the pilots, all of them but one are stored in an overflow array searched by binary search
+template <typename Key_Type, typename Value_Type,
+          typename Hasher = hash<Key_Type>, typename Key_Equal = equal_to<> >
+class Frozen_Table
+{
+    //Enabled for the key types K that can be used to search the table (see HashTable)
+    template <typename K>
+    using Lookup_Key = typename enable_if<is_same<K, Key_Type>::value ||
+                                          (has_transparent<Hasher>::value &&
+                                           has_transparent<Key_Equal>::value)>::type;
+
+    typedef typename Key_Storage<Key_Type>::type Stored_Key;
+
+public:
+
+    //Average number of keys per bucket
+    static constexpr unsigned BUCKET_SIZE = 5;
+
+    //Pilots tried for a bucket before the table is built again with another seed
+    static constexpr uint32_t MAX_PILOT = 1u << 26;
+
+    //Seeds tried before the keys are stored in the overflow array
+    static constexpr unsigned MAX_SEEDS = 16;
+
+
+    //Freeze table T: build a Frozen_Table with the items in T
+    //T is not modified and it can be destroyed afterwards
+    template <typename... Policies>
+    explicit Frozen_Table(const HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Policies...>& T,
+                          const Key_Equal& eq = Key_Equal());
+
+
+    //Return number of items stored in the table
+    unsigned get_number_OF_items() const
+    {
+        return n_slots + overflow.size();
+    }
+
+    //Return number of times the pilots were searched, 1 unless the search failed for some seed
+    unsigned get_count_build_attempts() const
+    {
+        return build_attempts;
+    }
+
+    //Return number of bytes used by the table, including the characters of string keys
+    size_t memory_usage() const
+    {
+        return pilots.capacity() * sizeof(uint32_t) +
+               slots.capacity() * sizeof(Slot) + overflow.capacity() * sizeof(Overflow_Item) +
+               keys.memory_usage();
+    }
+
+
+    //Return a pointer to the value associated with key
+    //If key does not exist in the table then nullptr is returned
+    const Value_Type* _find(const Key_Type& key) const
+    {
+        return _find<Key_Type>(key);
+    }
+
+    template <typename K, typename = Lookup_Key<K> >
+    const Value_Type* _find(const K& key) const;
+
+
+    //Call f(key, value) for every item in the table
+    template <typename Function>
+    void for_each(Function f) const
+    {
+        for (const Slot& s : slots)
+            f(s.key, s.value);
+
+        for (const Overflow_Item& s : overflow)
+            f(s.key, s.value);
+    }
+
+private:
+
+    struct Slot
+    {
+        size_t hash_value;  //compared before the keys, to reject most absent keys quickly
+        Stored_Key key;
+        Value_Type value;
+    };
+
+    typedef Slot Overflow_Item;  //sorted by hash value
+
+    const Hasher h;
+    const Key_Equal eq;
+
+    uint64_t seed = 0;
+    unsigned n_slots = 0;
+    unsigned n_buckets = 1;
+    unsigned build_attempts = 0;
+
+    vector<uint32_t> pilots;  //one per bucket
+    vector<Slot> slots;       //n_slots slots, all in use
+    vector<Overflow_Item> overflow;
+
+    //Arena where the characters of string keys are stored (see Key_Storage)
+    String_Arena keys;
+
+
+    unsigned bucket(size_t hv) const
+    {
+        return wy_mix(hv, seed ^ 0xa0761d6478bd642full) % n_buckets;
+    }
+
+    uint64_t pos_hash(size_t hv) const
+    {
+        return wy_mix(hv, seed ^ 0xe7037ed1a0b428dbull);
+    }
+
+    //The pilot is multiplied in, as in Static_Table: when n_slots is a power of 2, xor-ing a pilot
+    //only permutes the slots and cannot separate two keys whose pos_hash have the same low bits
+    unsigned slot(uint64_t pos_hash, uint32_t pilot) const
+    {
+        return wy_mix(pos_hash, pilot ^ 0x8ebc6af09c88c6e3ull) % n_slots;
+    }
+
+    //Search a pilot for every bucket, for the keys with the (distinct) hash values hv
+    //Return false if some bucket cannot be placed with this seed
+    //Otherwise, slot_of[j] is set to the slot of the key with hash value hv[j] and true is returned
+    bool place(const vector<size_t>& hv, vector<unsigned>& slot_of);
+
+    //Disable copy constructor!!
+    Frozen_Table(const Frozen_Table &) = delete;
+
+    //Disable assignment operator!!
+    const Frozen_Table& operator=(const Frozen_Table &) = delete;
+};
+
+
+/* ********************************** *
+* Member functions implementation     *
+* *********************************** */
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+template <typename... Policies>
+Frozen_Table<Key_Type, Value_Type, Hasher, Key_Equal>::Frozen_Table(const HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Policies...>& T,
+                                                                    const Key_Equal& _eq)
+    : h(T.hash_function()), eq(_eq)
+{
+    struct Source
+    {
+        size_t hv;
+        const Stored_Key* key;
+        const Value_Type* value;
+    };
+
+    vector<Source> items;
+    items.reserve(T.get_number_OF_items());
+
+    T.for_each_hashed([&items](const Stored_Key& key, const Value_Type& v, size_t hv)
+    {
+        items.push_back(Source { hv, &key, &v });
+    });
+
+    sort(items.begin(), items.end(), [](const Source& a, const Source& b) { return a.hv < b.hv; });
+
+    //keys with the same hash value as the previous one go to the overflow array
+    vector<Source> unique_items;
+    vector<size_t> hv;
+
+    for (unsigned i = 0; i < items.size(); ++i)
+    {
+        if (i > 0 && items[i].hv == items[i - 1].hv)
+        {
+            overflow.push_back(Overflow_Item { items[i].hv, Key_Storage<Key_Type>::store(*items[i].key, keys),
+                                               *items[i].value });
+            continue;
+        }
+
+        unique_items.push_back(items[i]);
+        hv.push_back(items[i].hv);
+    }
+
+    n_slots = hv.size();
+    n_buckets = max(1u, (n_slots + BUCKET_SIZE - 1) / BUCKET_SIZE);
+
+    vector<unsigned> slot_of(n_slots);
+
+    while (n_slots > 0 && !place(hv, slot_of))
+    {
+        if (++seed < MAX_SEEDS)
+            continue;
+
+        //no perfect hash function was found, all keys are searched by binary search
+        for (const Source& x : unique_items)
+            overflow.push_back(Overflow_Item { x.hv, Key_Storage<Key_Type>::store(*x.key, keys), *x.value });
+
+        stable_sort(overflow.begin(), overflow.end(), [](const Overflow_Item& a, const Overflow_Item& b)
+        {
+            return a.hash_value < b.hash_value;
+        });
+
+        n_slots = 0;
+        pilots.clear();
+    }
+
+    //store the items in slot order
+    vector<unsigned> item_in(n_slots);
+
+    for (unsigned j = 0; j < n_slots; ++j)
+        item_in[slot_of[j]] = j;
+
+    slots.reserve(n_slots);
+
+    for (unsigned s = 0; s < n_slots; ++s)
+    {
+        const Source& x = unique_items[item_in[s]];
+
+        slots.push_back(Slot { x.hv, Key_Storage<Key_Type>::store(*x.key, keys), *x.value });
+    }
+}
+
+
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+bool Frozen_Table<Key_Type, Value_Type, Hasher, Key_Equal>::place(const vector<size_t>& hv, vector<unsigned>& slot_of)
+{
+    ++build_attempts;
+
+    //group the keys by bucket (counting sort)
+    vector<unsigned> first(n_buckets + 1, 0);  //keys of bucket b are order[first[b], first[b+1])
+    vector<unsigned> order(hv.size());
+
+    for (size_t x : hv)
+        ++first[bucket(x) + 1];
+
+    for (unsigned b = 0; b < n_buckets; ++b)
+        first[b + 1] += first[b];
+
+    {
+        vector<unsigned> next(first.begin(), first.end() - 1);
+
+        for (unsigned j = 0; j < hv.size(); ++j)
+            order[next[bucket(hv[j])]++] = j;
+    }
+
+    //largest buckets first
+    vector<unsigned> by_size(n_buckets);
+
+    for (unsigned b = 0; b < n_buckets; ++b)
+        by_size[b] = b;
+
+    stable_sort(by_size.begin(), by_size.end(), [&first](unsigned a, unsigned b)
+    {
+        return first[a + 1] - first[a] > first[b + 1] - first[b];
+    });
+
+    pilots.assign(n_buckets, 0);
+
+    vector<bool> taken(n_slots, false);
+    vector<uint64_t> pos;   //pos_hash of the keys of the current bucket
+    vector<unsigned> tried; //their slots for the current pilot
+
+    for (unsigned b : by_size)
+    {
+        const unsigned size = first[b + 1] - first[b];
+
+        if (size == 0)
+            break;
+
+        pos.clear();
+
+        for (unsigned i = first[b]; i < first[b + 1]; ++i)
+            pos.push_back(pos_hash(hv[order[i]]));
+
+        uint32_t pilot = 0;
+
+        for (; pilot < MAX_PILOT; ++pilot)
+        {
+            tried.clear();
+
+            for (uint64_t p : pos)
+            {
+                unsigned s = slot(p, pilot);
+
+                if (taken[s] || find(tried.begin(), tried.end(), s) != tried.end())
+                    break;
+
+                tried.push_back(s);
+            }
+
+            if (tried.size() == size)
+                break;
+        }
+
+        if (pilot == MAX_PILOT)
+            return false;
+
+        pilots[b] = pilot;
+
+        for (unsigned i = 0; i < size; ++i)
+        {
+            taken[tried[i]] = true;
+            slot_of[order[first[b] + i]] = tried[i];
+        }
+    }
+
+    return true;
+}
+
+
+//Return a pointer to the value associated with key
+//If key does not exist in the table then nullptr is returned
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal>
+template <typename K, typename>
+const Value_Type* Frozen_Table<Key_Type, Value_Type, Hasher, Key_Equal>::_find(const K& key) const
+{
+    const size_t hv = h(key);
+
+    if (n_slots > 0)
+    {
+        const Slot& s = slots[slot(pos_hash(hv), pilots[bucket(hv)])];
+
+        if (s.hash_value == hv && eq(s.key, key))
+            return &s.value;
+    }
+
+    //keys with the same hash value as a key in the slots
+    auto it = lower_bound(overflow.begin(), overflow.end(), hv, [](const Overflow_Item& s, size_t x)
+    {
+        return s.hash_value < x;
+    });
+
+    for (; it != overflow.end() && it->hash_value == hv; ++it)
+    {
+        if (eq(it->key, key))
+            return &it->value;
+    }
+
+    return nullptr;
+}
+
+#endif // FROZENTABLE_H_INCLUDED
@@ -1,37 +1,85 @@
-
 /*
   Author: Aida Nordman
   Course: TND004, Lab 2
   Description: template class HashTable represents an open addressing hash table
               (also known as closed_hashing) with linear probing
+              Other collision resolution policies can be chosen (see probing.h)
 */
 
+#ifndef HASHTABLE_H_INCLUDED
+#define HASHTABLE_H_INCLUDED
+
 #include "Item.h"
+#include "tableStats.h"
+#include "probing.h"
+#include "bloomFilter.h"
 
 #include <iostream>
 #include <iomanip>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <memory>
+#include <chrono>
 
 using namespace std;
 
 const int NOT_FOUND = -1;
+//Default maximum load factor of a table (see HashTable::set_max_load_factor)
 const double MAX_LOAD_FACTOR = 0.5;
 
+//Number of keys hashed and prefetched together by the batch operations
+const unsigned PREFETCH_BATCH = 16;
+
+
+//Hint the processor to load the cache line at address p
+inline void prefetch(const void* p)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(p);
+#endif
+}
+
+
+//has_transparent<F>::value is true if the function object F declares the member type is_transparent,
+//i.e. F accepts other types than the table's key type (e.g. string_view for string keys)
+template <typename F, typename = void>
+struct has_transparent : false_type { };
+
+template <typename F>
+struct has_transparent<F, void_t<typename F::is_transparent> > : true_type { };
 
-//Template class to represent an open addressing hash table using linear probing to resolve collisions
+
+//Template class to represent an open addressing hash table using linear probing (by default) to resolve collisions
 //Internally the table is represented as an array of pointers to Items
-template <typename Key_Type, typename Value_Type>
+//Hasher is a function object returning the hash value of a key (see hashers.h)
+//Key_Equal is a function object testing whether two keys are equal
+//Note that Key_Equal compares the keys stored in the Items (see Key_Storage), e.g. string_views for string keys
+//If both Hasher and Key_Equal are transparent then the table can be searched with keys of
+//any type K accepted by them, e.g. string_view or const char* for string keys (heterogeneous lookup)
+//Stats is the instrumentation policy (see tableStats.h): No_Stats compiles it out,
+//Probe_Stats records probe length histograms and re-hash durations
+//Probing is the collision resolution policy (see probing.h): Linear_Probing, Quadratic_Probing,
+//Double_Hashing, or Cuckoo_Hashing. The probe lengths reported to Stats are the slots visited,
+//thus they can be compared across policies
+template <typename Key_Type, typename Value_Type,
+          typename Hasher = hash<Key_Type>, typename Key_Equal = equal_to<>, typename Stats = No_Stats,
+          typename Probing = Linear_Probing>
 class HashTable
 {
-public:
-
-    //New type HASH: pointer to a hash function
-    typedef unsigned (*HASH)(Key_Type, int);
+    //Enabled for the key types K that can be used to search the table
+    template <typename K>
+    using Lookup_Key = typename enable_if<is_same<K, Key_Type>::value ||
+                                          (has_transparent<Hasher>::value &&
+                                           has_transparent<Key_Equal>::value)>::type;
 
+public:
 
     //Constructor to create a hash table
     //table_size is number of slots in the table (next prime number is used)
-    //f is the hash function
-    HashTable(int table_size, HASH f);
+    //f is the hash function object and eq the key equality function object
+    HashTable(int table_size, const Hasher& f = Hasher(), const Key_Equal& eq = Key_Equal());
 
 
     //Destructor
@@ -51,48 +99,160 @@ public:
         return nItems;
     }
 
+    //Return number of slots in the table
+    unsigned get_size() const
+    {
+        return _size;
+    }
+
+    //Return the load factor that triggers a re-hash
+    double get_max_load_factor() const
+    {
+        return max_load_factor;
+    }
+
+    //Set the load factor that triggers a re-hash to f, 0 < f <= Probing::MAX_LOAD
+    //Higher values use less memory but make the probe sequences longer
+    //The table is re-hashed now if it is already too full for f
+    void set_max_load_factor(double f);
+
+    //Re-hash, if needed, so that n items can be stored without any further re-hash
+    void reserve(unsigned n);
+
+    //Re-hash to the smallest table that stores the current items below the max load factor
+    //Deleted slots are dropped
+    void shrink_to_fit();
+
+    //Return number of bytes used by the table: slots, Items, characters of string keys, and Bloom filter
+    size_t memory_usage() const
+    {
+        return _size * sizeof(Item<Key_Type, Value_Type>*) + items.memory_usage() + keys.memory_usage() +
+               (filter ? filter->memory_usage() : 0);
+    }
+
+    //Put a Bloom filter in front of the searches (_find, find_many, and _remove), so that most absent keys
+    //are rejected by reading one cache line, without probing the table
+    //fp_rate is the false positive rate of the filter, 0 < fp_rate < 1
+    //The filter is updated by every insertion and re-built by every re-hash, removed keys stay in it until then
+    void enable_filter(double fp_rate = 0.01);
+
+    //Remove the Bloom filter
+    void disable_filter()
+    {
+        filter.reset();
+    }
+
+    //Return the Bloom filter, or nullptr if there is none
+    //Its statistics count the searches saved and the false positives (see Bloom_Filter::get_stats)
+    const Bloom_Filter* get_filter() const
+    {
+        return filter.get();
+    }
+
     //Return the total number of visited slots (during search, insert, remove, or re-hash)
     unsigned get_total_visited_slots() const
     {
         return total_visited_slots;
     }
 
-    //Return the total number of call to new Item()
+    //Return the total number of Items created
+    //Items are not allocated one by one but taken from the table's arena
     unsigned get_count_new_items() const
     {
         return count_new_items;
     }
 
+    //Return the number of memory allocations done for Items and keys
+    unsigned get_count_allocations() const
+    {
+        return items.get_count_allocations() + keys.get_count_allocations();
+    }
+
 
     //Return a pointer to the value associated with key
     //If key does not exist in the table then nullptr is returned
-    const Value_Type* _find(const Key_Type& key);
+    const Value_Type* _find(const Key_Type& key)
+    {
+        return _find<Key_Type>(key);
+    }
+
+    template <typename K, typename = Lookup_Key<K> >
+    const Value_Type* _find(const K& key)
+    {
+        return find_hashed(key, h(key));
+    }
 
 
     //Insert the Item (key, v) in the table
     //If key already exists in the table then change the value associated with key to v
-    //Re-hash if the table reaches the MAX_LOAD_FACTOR
-    void _insert(const Key_Type& key, const Value_Type& v);
+    //Re-hash if the table reaches the max load factor
+    void _insert(const Key_Type& key, const Value_Type& v)
+    {
+        _insert<Key_Type>(key, v);
+    }
+
+    template <typename K, typename = Lookup_Key<K> >
+    void _insert(const K& key, const Value_Type& v)
+    {
+        insert_hashed(key, v, h(key));
+    }
 
 
     //Remove Item with key, if the item exists
     //If an Item was removed then return true
     //otherwise, return false
-    bool _remove(const Key_Type& key);
+    bool _remove(const Key_Type& key)
+    {
+        return _remove<Key_Type>(key);
+    }
+
+    template <typename K, typename = Lookup_Key<K> >
+    bool _remove(const K& key)
+    {
+        return remove_hashed(key, h(key));
+    }
 
     //Overloaded subscript operator
     //If key is not in the table then insert a new Item = (key, Value_Type())
-    Value_Type& operator[](const Key_Type& key);
+    //A Key_Type copy of key is only created when a new Item is inserted
+    Value_Type& operator[](const Key_Type& key)
+    {
+        return operator[]<Key_Type>(key);
+    }
+
+    template <typename K, typename = Lookup_Key<K> >
+    Value_Type& operator[](const K& key)
+    {
+        return subscript_hashed(key, h(key));
+    }
+
+
+    //Batch operations on the n keys in array keys
+    //The keys are processed in groups of PREFETCH_BATCH: all keys of a group are hashed and their slots
+    //prefetched before the first key is searched, so that the memory accesses overlap
+
+    //values[i] is set to _find(keys[i])
+    template <typename K, typename = Lookup_Key<K> >
+    void find_many(const K keys[], unsigned n, const Value_Type* values[]);
+
+    //_insert(keys[i], values[i]) for i = 0, ..., n-1
+    template <typename K, typename = Lookup_Key<K> >
+    void insert_many(const K keys[], const Value_Type values[], unsigned n);
+
+    //++operator[](keys[i]) for i = 0, ..., n-1
+    template <typename K, typename = Lookup_Key<K> >
+    void increment_many(const K keys[], unsigned n);
 
 
     //Display all items in table T to stream os
+    //Lines end with '\n' rather than endl, so that os is not flushed once per item
     friend ostream& operator<<(ostream& os, const HashTable& T)
     {
         for (unsigned i = 0; i < T._size; ++i)
         {
             if (T.hTable[i] && T.hTable[i] != Deleted_Item<Key_Type,Value_Type>::get_Item())
             {
-                os << *T.hTable[i] << endl;
+                os << *T.hTable[i] << '\n';
             }
         }
 
@@ -100,6 +260,39 @@ public:
     }
 
 
+    //Call f(key, value) for every item in the table, in slot order
+    template <typename Function>
+    void for_each(Function f) const;
+
+    //Call f(key, value, hv) for every item in the table, in slot order
+    //hv is the hash value of key cached in the item
+    template <typename Function>
+    void for_each_hashed(Function f) const;
+
+    //Return the hash function object
+    const Hasher& hash_function() const
+    {
+        return h;
+    }
+
+
+    //Add the value of each item in T to the value associated with the same key in this table
+    //Keys not in this table are inserted, the hash values cached in T's items are re-used
+    void merge(const HashTable& T);
+
+
+    //Return the statistics recorded by the Stats policy
+    const Stats& get_stats() const
+    {
+        return stats;
+    }
+
+    //Scan the table and return its occupancy: tombstones, clusters, displacement of the items
+    //in their probe sequences, and hash quality
+    //Available with any Stats policy, it visits all slots
+    Table_Shape analyze() const;
+
+
     //Display the table for debug and testing purposes
     //Thus, empty and deleted entries are also displayed
     void display(ostream& os);
@@ -107,6 +300,10 @@ public:
 
 private:
 
+    //Shards of a Concurrent_HashTable share the hash value computed to select the shard
+    template <typename, typename, typename, typename>
+    friend class Concurrent_HashTable;
+
     /* ********************************** *
     * Data members                        *
     * *********************************** */
@@ -114,8 +311,11 @@ private:
     //Number of slots in the table, a prime number
     unsigned _size;
 
-    //Hash function
-    const HASH h;
+    //Hash function object
+    const Hasher h;
+
+    //Key equality function object
+    const Key_Equal eq;
 
     //Number of items stored in the table
     //Instances of Deleted_Items are not counted
@@ -124,20 +324,115 @@ private:
     //Number of slots that are marked as deleted
     unsigned nDeleted;
 
+    //The table is re-hashed when its load factor reaches max_load_factor
+    double max_load_factor;
+
     //Table is an array of pointers to Items
     //Each slot of the table stores a pointer to an Item =(key, value)
     Item<Key_Type, Value_Type>** hTable;
 
+    //Arena where the Items are allocated
+    Slab_Allocator<Item<Key_Type, Value_Type> > items;
+
+    //Arena where the characters of string keys are stored (see Key_Storage)
+    String_Arena keys;
+
     //Some statistics
     unsigned total_visited_slots;  //total number of visited slots
-    unsigned count_new_items;      //number of calls to new Item()
+    unsigned count_new_items;      //number of Items created
+
+    //Instrumentation policy
+    Stats stats;
+
+    //Optional Bloom filter of the hash values of the keys (see enable_filter)
+    unique_ptr<Bloom_Filter> filter;
+
+    //State of the random generator choosing the keys moved by cuckoo hashing (see make_room)
+    uint32_t kick_state = 2463534242u;
+
+    //Slots written while making room, with their previous contents, to undo a failed attempt
+    vector<pair<unsigned, Item<Key_Type, Value_Type>*> > kick_log;
 
 
     /* ********************************** *
     * Auxiliar member functions           *
     * *********************************** */
 
-    void rehash();
+    //_find, _insert, _remove, and operator[] for a key whose hash value hv is already computed
+    template <typename K>
+    const Value_Type* find_hashed(const K& key, size_t hv);
+
+    template <typename K>
+    void insert_hashed(const K& key, const Value_Type& v, size_t hv);
+
+    template <typename K>
+    bool remove_hashed(const K& key, size_t hv);
+
+    template <typename K>
+    Value_Type& subscript_hashed(const K& key, size_t hv);
+
+    //Return the slot storing key, whose hash value is hv
+    //If key is not in the table then the slot where key should be inserted is returned
+    //found is set to true if and only if key is in the table
+    //The probe length is reported to stats as an operation op
+    template <typename K>
+    unsigned probe(const K& key, size_t hv, bool& found, Table_Operation op);
+
+    //probe() for cuckoo hashing: all slots of both buckets of key are visited
+    //If key is not in the table and op is INSERT_OP then an empty slot is always returned,
+    //keys are moved to their other bucket, or the table grows, if needed
+    template <typename K>
+    unsigned probe_cuckoo(const K& key, size_t hv, bool& found, Table_Operation op);
+
+    //Cuckoo hashing: empty a slot in one of the buckets of the hash value hv, both being full,
+    //by moving keys to their other bucket (a random walk of at most Probing::MAX_KICKS moves)
+    //Return the emptied slot, or _size if no room was made (the table is then left unchanged)
+    //visited is increased by the number of slots visited
+    unsigned make_room(size_t hv, unsigned& visited);
+
+    //Store Item p, being moved by rehash(), in an empty slot
+    //Return false if no slot was found (only possible with cuckoo hashing)
+    bool place(Item<Key_Type, Value_Type>* p);
+
+    //Return a random number, xorshift generator
+    uint32_t next_random()
+    {
+        kick_state ^= kick_state << 13;
+        kick_state ^= kick_state >> 17;
+        kick_state ^= kick_state << 5;
+        return kick_state;
+    }
+
+    //Compute the hash values hv[i] of the n <= PREFETCH_BATCH keys
+    //and prefetch their home slots and the Items stored there
+    template <typename K>
+    void prefetch_batch(const K keys[], unsigned n, size_t hv[]);
+
+    //Create a new Item (key, v) in slot index, returned by probe()
+    //A copy of the key is stored in the arena
+    template <typename K>
+    Item<Key_Type, Value_Type>* new_item(unsigned index, const K& key,
+                                         const Value_Type& v, size_t hv);
+
+    //Size the Bloom filter for the items that fit in the table and add their hash values
+    void rebuild_filter();
+
+    //Re-hash to the table size doubled
+    void grow()
+    {
+        rehash(_size * 2);
+    }
+
+    //Re-hash to a table of at least n_slots slots (next prime number is used)
+    //and at least Probing::MIN_SIZE slots, as in the constructor
+    //With cuckoo hashing, the table is made larger if its items cannot be placed
+    void rehash(unsigned n_slots);
+
+    //Return number of slots needed to store n items below the max load factor
+    unsigned slots_for(unsigned n) const
+    {
+        return (unsigned) (n / max_load_factor) + 1;
+    }
 
     //Disable copy constructor!!
     HashTable(const HashTable &) = delete;
@@ -148,130 +443,435 @@ private:
 };
 
 
-//Test if a number is prime
-bool isPrime( int n );
-
-//Return a prime number at least as large as n
-int nextPrime( int n );
-
-
 /* ********************************** *
 * Member functions implementation     *
 * *********************************** */
 
 //Constructor to create a hash table
 //table_size number of slots in the table (next prime number is used)
-//f is the hash function
-template <typename Key_Type, typename Value_Type>
-HashTable<Key_Type, Value_Type>::HashTable(int table_size, HASH f)
-    : h(f)
+//f is the hash function object and eq the key equality function object
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::HashTable(int table_size, const Hasher& f,
+                                                              const Key_Equal& _eq)
+    : h(f), eq(_eq)
 {
-    //IMPLEMENT
-    _size = nextPrime(table_size);
+    _size = nextPrime(max(table_size, (int) Probing::MIN_SIZE));
     hTable = new Item<Key_Type, Value_Type>*[_size];
-    for(int i = 0; i < _size; ++i)
+    for(unsigned i = 0; i < _size; ++i)
     {
         hTable[i] = nullptr;
     }
     nDeleted = 0;
     nItems = 0;
+    max_load_factor = min(MAX_LOAD_FACTOR, Probing::MAX_LOAD);
+    total_visited_slots = 0;
+    count_new_items = 0;
 }
 
 
 //Destructor
-template <typename Key_Type, typename Value_Type>
-HashTable<Key_Type, Value_Type>::~HashTable()
+//The memory of the Items and keys is released in bulk by the arenas
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::~HashTable()
 {
-    //IMPLEMENT
+    if(!is_trivially_destructible<Item<Key_Type, Value_Type> >::value)
+    {
+        const Item<Key_Type, Value_Type>* deleted = Deleted_Item<Key_Type, Value_Type>::get_Item();
+
+        for(unsigned i = 0; i < _size; ++i)
+        {
+            if(hTable[i] && hTable[i] != deleted)
+                hTable[i]->~Item();
+        }
+    }
     delete[] hTable;
 }
 
 
 //Return a pointer to the value associated with key
 //If key does not exist in the table then nullptr is returned
-template <typename Key_Type, typename Value_Type>
-const Value_Type* HashTable<Key_Type, Value_Type>::_find(const Key_Type& key)
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K>
+const Value_Type* HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::find_hashed(const K& key, size_t hv)
 {
-    //IMPLEMENT
-    if(hTable[h(key, _size)])
+    if(filter && !filter->query(hv))
+        return nullptr;
+
+    bool found;
+    unsigned index = probe(key, hv, found, FIND_OP);
+
+    if(found)
     {
-        return &(hTable[h(key, _size)]->get_value());
+        return &(hTable[index]->get_value());
     }
+
+    if(filter)
+        filter->false_positive();
     return nullptr;
-    //return (new Value_Type()); //delete this code
 }
 
 
 //Insert the Item (key, v) in the table
 //If key already exists in the table then change the value associated with key to v
-//Re-hash if the table reaches the MAX_LOAD_FACTOR
-template <typename Key_Type, typename Value_Type>
-void HashTable<Key_Type, Value_Type>::_insert(const Key_Type& key, const Value_Type& v)
+//Re-hash if the table reaches the max load factor
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::insert_hashed(const K& key, const Value_Type& v, size_t hv)
 {
-    //IMPLEMENT
-    unsigned index = h(key, _size);
-    if(!hTable[index])
+    bool found;
+    unsigned index = probe(key, hv, found, INSERT_OP);
+
+    if(found)
     {
-        Item<Key_Type, Value_Type> *temp = new Item<Key_Type, Value_Type>(key, v);
-        //cout << "Inserting: " << *temp << "\n";
-        hTable[index] = temp;
-        ++nItems;
+        hTable[index]->set_value(v);
+        return;
     }
-    else
+
+    new_item(index, key, v, hv);
+
+    if(loadFactor() >= max_load_factor)
+       grow();
+}
+
+
+//Remove Item with key, if the item exists
+//If an Item was removed then return true
+//otherwise, return false
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K>
+bool HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::remove_hashed(const K& key, size_t hv)
+{
+    if(filter && !filter->query(hv))
+        return false;
+
+    bool found;
+    unsigned index = probe(key, hv, found, REMOVE_OP);
+
+    if(!found)
     {
-        for(; index <= _size; ++index)
+        if(filter)
+            filter->false_positive();
+        return false;
+    }
+
+    items.destroy(hTable[index]);
+    --nItems;
+
+    //cuckoo hashing searches all slots of both buckets, thus no deleted mark is needed
+    if constexpr (Probing::cuckoo)
+    {
+        hTable[index] = nullptr;
+        return true;
+    }
+
+    hTable[index] = Deleted_Item<Key_Type, Value_Type>::get_Item();
+    ++nDeleted;
+    return true;
+}
+
+
+//Overloaded subscript operator
+//If key is not in the table then insert a new Item = (key, Value_Type())
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K>
+Value_Type& HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::subscript_hashed(const K& key, size_t hv)
+{
+    bool found;
+    unsigned index = probe(key, hv, found, INSERT_OP);
+
+    if(found)
+        return hTable[index]->get_value();
+
+    //Items are not moved by rehash(), so the reference stays valid
+    Item<Key_Type, Value_Type>* p = new_item(index, key, Value_Type(), hv);
+
+    if(loadFactor() >= max_load_factor)
+       grow();
+
+    return p->get_value();
+}
+
+
+//values[i] is set to _find(keys[i])
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K, typename>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::find_many(const K keys[], unsigned n,
+                                                                   const Value_Type* values[])
+{
+    size_t hv[PREFETCH_BATCH];
+
+    for(unsigned first = 0; first < n; first += PREFETCH_BATCH)
+    {
+        unsigned m = min(PREFETCH_BATCH, n - first);
+
+        prefetch_batch(keys + first, m, hv);
+
+        for(unsigned i = 0; i < m; ++i)
+            values[first + i] = find_hashed(keys[first + i], hv[i]);
+    }
+}
+
+
+//_insert(keys[i], values[i]) for i = 0, ..., n-1
+//If the table is re-hashed in the middle of a group then the remaining prefetches are wasted,
+//but probe() always uses the current table size
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K, typename>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::insert_many(const K keys[], const Value_Type values[],
+                                                                     unsigned n)
+{
+    size_t hv[PREFETCH_BATCH];
+
+    for(unsigned first = 0; first < n; first += PREFETCH_BATCH)
+    {
+        unsigned m = min(PREFETCH_BATCH, n - first);
+
+        prefetch_batch(keys + first, m, hv);
+
+        for(unsigned i = 0; i < m; ++i)
         {
-            if(index == _size)
+            bool found;
+            unsigned index = probe(keys[first + i], hv[i], found, INSERT_OP);
+
+            if(found)
             {
-                index = 0;
+                hTable[index]->set_value(values[first + i]);
+                continue;
             }
-            if(!hTable[index])
+
+            new_item(index, keys[first + i], values[first + i], hv[i]);
+
+            if(loadFactor() >= max_load_factor)
+                grow();
+        }
+    }
+}
+
+
+//++operator[](keys[i]) for i = 0, ..., n-1
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K, typename>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::increment_many(const K keys[], unsigned n)
+{
+    size_t hv[PREFETCH_BATCH];
+
+    for(unsigned first = 0; first < n; first += PREFETCH_BATCH)
+    {
+        unsigned m = min(PREFETCH_BATCH, n - first);
+
+        prefetch_batch(keys + first, m, hv);
+
+        for(unsigned i = 0; i < m; ++i)
+        {
+            bool found;
+            unsigned index = probe(keys[first + i], hv[i], found, INSERT_OP);
+
+            if(found)
             {
-                Item<Key_Type, Value_Type> *temp = new Item<Key_Type, Value_Type>(key, v);
-                //cout << "Inserting: " << *temp << "\n";
-                hTable[index] = temp;
-                ++nItems;
-                break;
+                ++hTable[index]->get_value();
+                continue;
             }
+
+            ++new_item(index, keys[first + i], Value_Type(), hv[i])->get_value();
+
+            if(loadFactor() >= max_load_factor)
+                grow();
         }
     }
-    if(loadFactor() >= MAX_LOAD_FACTOR)
-       rehash();
 }
 
 
-//Remove Item with key, if the item exists
-//If an Item was removed then return true
-//otherwise, return false
-template <typename Key_Type, typename Value_Type>
-bool HashTable<Key_Type, Value_Type>::_remove(const Key_Type& key)
+//Call f(key, value) for every item in the table, in slot order
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename Function>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::for_each(Function f) const
+{
+    const Item<Key_Type, Value_Type>* deleted = Deleted_Item<Key_Type, Value_Type>::get_Item();
+
+    for(unsigned i = 0; i < _size; ++i)
+    {
+        if(hTable[i] && hTable[i] != deleted)
+            f(hTable[i]->get_key(), hTable[i]->get_value());
+    }
+}
+
+
+//Call f(key, value, hv) for every item in the table, in slot order
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename Function>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::for_each_hashed(Function f) const
+{
+    const Item<Key_Type, Value_Type>* deleted = Deleted_Item<Key_Type, Value_Type>::get_Item();
+
+    for(unsigned i = 0; i < _size; ++i)
+    {
+        if(hTable[i] && hTable[i] != deleted)
+            f(hTable[i]->get_key(), hTable[i]->get_value(), hTable[i]->get_hash());
+    }
+}
+
+
+//Add the value of each item in T to the value associated with the same key in this table
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::merge(const HashTable& T)
+{
+    const Item<Key_Type, Value_Type>* deleted = Deleted_Item<Key_Type, Value_Type>::get_Item();
+
+    for(unsigned i = 0; i < T._size; ++i)
+    {
+        if(T.hTable[i] && T.hTable[i] != deleted)
+            subscript_hashed(T.hTable[i]->get_key(), T.hTable[i]->get_hash()) += T.hTable[i]->get_value();
+    }
+}
+
+
+//Set the load factor that triggers a re-hash to f, 0 < f <= Probing::MAX_LOAD
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::set_max_load_factor(double f)
+{
+    //at least one slot must stay empty, so that probing stops
+    //quadratic probing needs half of the slots empty and cuckoo hashing some slack to move keys
+    max_load_factor = min(max(f, 0.01), Probing::MAX_LOAD);
+
+    if(loadFactor() >= max_load_factor)
+        rehash(slots_for(nItems + 1));
+}
+
+
+//Re-hash, if needed, so that n items can be stored without any further re-hash
+//Deleted slots count as used until the next re-hash
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::reserve(unsigned n)
+{
+    if(slots_for(n + nDeleted) > _size)
+        rehash(slots_for(n));
+}
+
+
+//Re-hash to the smallest table that stores the current items below the max load factor
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::shrink_to_fit()
+{
+    unsigned n_slots = nextPrime(max(slots_for(nItems), Probing::MIN_SIZE));
+
+    if(n_slots < _size || nDeleted > 0)
+        rehash(n_slots);
+}
+
+
+//Put a Bloom filter in front of the searches
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::enable_filter(double fp_rate)
+{
+    filter.reset(new Bloom_Filter(1, fp_rate));
+    rebuild_filter();
+}
+
+
+//The filter is sized for the items stored when the table reaches the max load factor
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::rebuild_filter()
+{
+    filter->resize(max(nItems + 1, (unsigned) (_size * max_load_factor) + 1));
+
+    for_each_hashed([this](const typename Item<Key_Type, Value_Type>::Stored_Key&, const Value_Type&, size_t hv)
+    {
+        filter->add(hv);
+    });
+}
+
+
+//Scan the table and return its occupancy
+//The displacement of an item is its position in its probe sequence, 0 for the home slot
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+Table_Shape HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::analyze() const
 {
-    //IMPLEMENT
-    unsigned index = h(key, _size);
-    while(hTable[index])
+    const Item<Key_Type, Value_Type>* deleted = Deleted_Item<Key_Type, Value_Type>::get_Item();
+    Table_Shape S;
+    vector<size_t> hashes;
+
+    S.size = _size;
+    hashes.reserve(nItems);
+
+    //the table is never full, start after an empty slot so that no cluster wraps around
+    unsigned start = 0;
+
+    while(hTable[start])
+        ++start;
+
+    unsigned run = 0;
+
+    for(unsigned k = 1; k <= _size; ++k)
     {
-        if(hTable[index]->get_key() != key)
+        unsigned i = (start + k) % _size;
+
+        if(!hTable[i])
         {
-            cout << "Current key: " << hTable[index]->get_key() << "\n";
-            ++index;
-            if(index == _size)
-                index = 0;
+            if(run)
+                S.clusters.add(run);
+            run = 0;
             continue;
         }
-        hTable[index] = Deleted_Item<Key_Type, Value_Type>::get_Item();
-        --nItems;
-        ++nDeleted;
-        return true;
+
+        ++run;
+
+        if(hTable[i] == deleted)
+        {
+            ++S.deleted;
+            continue;
+        }
+
+        ++S.items;
+
+        unsigned d = 0;
+
+        for(typename Probing::Sequence s(hTable[i]->get_hash(), _size); *s != i && !s.at_end(); ++s)
+            ++d;
+
+        S.displacement.add(d);
+        hashes.push_back(hTable[i]->get_hash());
     }
-    return false;
+
+    sort(hashes.begin(), hashes.end());
+
+    for(unsigned i = 0; i < hashes.size(); ++i)
+    {
+        if((i > 0 && hashes[i] == hashes[i - 1]) || (i + 1 < hashes.size() && hashes[i] == hashes[i + 1]))
+            ++S.equal_hashes;
+    }
+
+    double a = (double) (S.items + S.deleted) / _size;
+
+    S.expected_displacement = Probing::expected_displacement(a);
+
+    return S;
 }
 
 
 //Display the table for debug and testing purposes
 //This function is used for debugging and testing purposes
 //Thus, empty and deleted entries are also displayed
-template <typename Key_Type, typename Value_Type>
-void HashTable<Key_Type, Value_Type>::display(ostream& os)
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::display(ostream& os)
 {
     os << "-------------------------------\n";
     os << "Number of items in the table: " << get_number_OF_items() << endl;
@@ -291,9 +891,8 @@ void HashTable<Key_Type, Value_Type>::display(ostream& os)
         }
         else
         {
-            //cout << "Neither deleted nor null\n";
             os << *hTable[i]
-               << "  (" << h(hTable[i]->get_key(),_size) << ")" << endl;
+               << "  (" << *typename Probing::Sequence(hTable[i]->get_hash(), _size) << ")" << endl;
         }
     }
 
@@ -304,64 +903,289 @@ void HashTable<Key_Type, Value_Type>::display(ostream& os)
 /* ********************************** *
 * Auxiliar member functions           *
 * *********************************** */
-template <typename Key_Type, typename Value_Type>
-void HashTable<Key_Type, Value_Type>::rehash()
+
+//Visit the slots of the probe sequence of key until key or an empty slot is found
+//The first deleted slot found is re-used when key is not in the table
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K>
+unsigned HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::probe(const K& key, size_t hv, bool& found,
+                                                                          Table_Operation op)
 {
-    cout << "Rehashing ...\n";
-    nItems = 0;
-    unsigned old_size = _size;
-    _size = nextPrime(_size*2);
-    Item<Key_Type, Value_Type>** oldTable = hTable;
-    hTable = new Item<Key_Type, Value_Type>*[_size];
-    for(int i = 0; i < _size; ++i)
+    if constexpr (Probing::cuckoo)
     {
-        hTable[i] = nullptr;
+        return probe_cuckoo(key, hv, found, op);
     }
-    for(int idt = 0; idt < old_size; ++idt)
+    else
     {
-        if(oldTable[idt])
+        const Item<Key_Type, Value_Type>* deleted = Deleted_Item<Key_Type, Value_Type>::get_Item();
+        typename Probing::Sequence s(hv, _size);
+        unsigned first_deleted = _size; //no deleted slot seen yet
+        unsigned length = 1;            //slots visited
+
+        found = false;
+
+        //The table is never full (max_load_factor < 1), so the loop stops at an empty slot
+        for(; hTable[*s]; ++s, ++length)
         {
-            //cout << oldTable[idt]->get_key() << "\n";
-            _insert(oldTable[idt]->get_key(), oldTable[idt]->get_value());
+            if(hTable[*s] == deleted)
+            {
+                if(first_deleted == _size)
+                    first_deleted = *s;
+            }
+            else if(hTable[*s]->get_hash() == hv && eq(hTable[*s]->get_key(), key))
+            {
+                found = true;
+                break;
+            }
         }
 
+        total_visited_slots += length;
+        stats.on_probe(op, length);
+
+        if(found)
+            return *s;
+
+        return (first_deleted != _size) ? first_deleted : *s;
     }
-    delete[] oldTable;
-    cout << "New size = " << _size << "\n";
 }
 
 
-/* ********************************** *
-* Functions to find prime numbers     *
-* *********************************** */
+//Both buckets are searched, the first empty slot is returned when key is not in the table
+//If there is none, a search returns _size and an insertion makes room
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K>
+unsigned HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::probe_cuckoo(const K& key, size_t hv,
+                                                                                 bool& found, Table_Operation op)
+{
+    unsigned length = 0; //slots visited
+
+    for(;;)
+    {
+        unsigned index = _size;
+
+        found = false;
 
+        for(typename Probing::Sequence s(hv, _size); !s.at_end(); ++s)
+        {
+            ++length;
 
-//Test if a number is prime
-bool isPrime( int n )
+            if(!hTable[*s])
+            {
+                if(index == _size)
+                    index = *s;
+            }
+            else if(hTable[*s]->get_hash() == hv && eq(hTable[*s]->get_key(), key))
+            {
+                found = true;
+                index = *s;
+                break;
+            }
+        }
+
+        if(!found && index == _size && op == INSERT_OP)
+            index = make_room(hv, length);
+
+        if(index != _size || op != INSERT_OP)
+        {
+            total_visited_slots += length;
+            stats.on_probe(op, length);
+            return index;
+        }
+
+        //the keys could not be moved, search again in a larger table
+        grow();
+    }
+}
+
+
+//Cuckoo hashing: random walk, a key of a full bucket is moved to its other bucket,
+//which may evict another key, and so on until a key is moved to an empty slot
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+unsigned HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::make_room(size_t hv, unsigned& visited)
 {
-    if( n == 2 || n == 3 )
-        return true;
+    if constexpr (Probing::cuckoo)
+    {
+        static_assert(Probing::BUCKET >= 2, "a bucket must have at least two slots");
 
-    if( n == 1 || n % 2 == 0 )
-        return false;
+        const unsigned B = Probing::BUCKET;
+        Item<Key_Type, Value_Type>* reserved = Deleted_Item<Key_Type, Value_Type>::get_Item();
 
-    for( int i = 3; i * i <= n; i += 2 )
-        if( n % i == 0 )
-            return false;
+        //the slot to empty is marked, so that no key is moved into it
+        unsigned b = Probing::bucket(hv, _size, next_random() & 1);
+        unsigned hole = b * B + next_random() % B;
+        Item<Key_Type, Value_Type>* moving = hTable[hole];
 
-    return true;
+        kick_log.clear();
+        kick_log.emplace_back(hole, moving);
+        hTable[hole] = reserved;
+
+        for(unsigned kick = 0; kick < Probing::MAX_KICKS; ++kick)
+        {
+            //the other bucket of the moving key
+            unsigned b0 = Probing::bucket(moving->get_hash(), _size, 0);
+            unsigned b1 = Probing::bucket(moving->get_hash(), _size, 1);
+
+            b = (b == b0) ? b1 : b0;
+
+            for(unsigned i = 0; i < B; ++i)
+            {
+                ++visited;
+
+                if(!hTable[b * B + i])
+                {
+                    hTable[b * B + i] = moving;
+                    hTable[hole] = nullptr;
+                    return hole;
+                }
+            }
+
+            //evict a key of the full bucket, never the reserved slot
+            unsigned victim = b * B + next_random() % B;
+
+            if(hTable[victim] == reserved)
+                victim = b * B + (victim - b * B + 1) % B;
+
+            kick_log.emplace_back(victim, hTable[victim]);
+            swap(moving, hTable[victim]);
+        }
+
+        //undo the moves
+        for(auto it = kick_log.rbegin(); it != kick_log.rend(); ++it)
+            hTable[it->first] = it->second;
+    }
+
+    return _size;
 }
 
 
-//Return a prime number at least as large as n
-int nextPrime( int n )
+//Two passes over the group: the first one prefetches the home slots,
+//the second one reads the slots (hopefully in cache by then) and prefetches the Items
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::prefetch_batch(const K keys[], unsigned n, size_t hv[])
 {
-    if( n % 2 == 0 )
-        n++;
+    const Item<Key_Type, Value_Type>* deleted = Deleted_Item<Key_Type, Value_Type>::get_Item();
 
-    for(; !isPrime( n ); n += 2 );
+    for(unsigned i = 0; i < n; ++i)
+    {
+        hv[i] = h(keys[i]);
+        prefetch(&hTable[*typename Probing::Sequence(hv[i], _size)]);
+    }
 
-    return n;
+    for(unsigned i = 0; i < n; ++i)
+    {
+        const Item<Key_Type, Value_Type>* p = hTable[*typename Probing::Sequence(hv[i], _size)];
+
+        if(p && p != deleted)
+            prefetch(p);
+    }
 }
 
 
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+template <typename K>
+Item<Key_Type, Value_Type>* HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::new_item(unsigned index,
+                    const K& key, const Value_Type& v, size_t hv)
+{
+    if(hTable[index])  //re-use a deleted slot
+        --nDeleted;
+
+    hTable[index] = items.create(Key_Storage<Key_Type>::store(key, keys), v, hv);
+    ++nItems;
+    ++count_new_items;
+
+    if(filter)
+    {
+        if(filter->is_full())  //the max load factor was raised
+            rebuild_filter();
+        else
+            filter->add(hv);
+    }
+
+    return hTable[index];
+}
+
+
+//Items are moved to the new table using their cached hash values
+//Deleted slots are dropped
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+void HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::rehash(unsigned n_slots)
+{
+    chrono::steady_clock::time_point start;
+
+    if constexpr (Stats::enabled)
+        start = chrono::steady_clock::now();
+
+    const Item<Key_Type, Value_Type>* deleted = Deleted_Item<Key_Type, Value_Type>::get_Item();
+    unsigned old_size = _size;
+    Item<Key_Type, Value_Type>** oldTable = hTable;
+
+    for(;;)
+    {
+        _size = nextPrime(max(n_slots, Probing::MIN_SIZE));
+        hTable = new Item<Key_Type, Value_Type>*[_size];
+        for(unsigned i = 0; i < _size; ++i)
+        {
+            hTable[i] = nullptr;
+        }
+
+        unsigned idt = 0;
+
+        for(; idt < old_size; ++idt)
+        {
+            if(oldTable[idt] && oldTable[idt] != deleted && !place(oldTable[idt]))
+                break;
+        }
+
+        if(idt == old_size)
+            break;
+
+        //cuckoo hashing could not place some item, the old table is intact
+        delete[] hTable;
+        n_slots = _size * 2;
+    }
+    nDeleted = 0;
+    delete[] oldTable;
+
+    //removed keys are dropped from the filter
+    if(filter)
+        rebuild_filter();
+
+    if constexpr (Stats::enabled)
+        stats.on_rehash(old_size, _size, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+}
+
+
+//The new table has no deleted slots
+template <typename Key_Type, typename Value_Type, typename Hasher, typename Key_Equal, typename Stats,
+          typename Probing>
+bool HashTable<Key_Type, Value_Type, Hasher, Key_Equal, Stats, Probing>::place(Item<Key_Type, Value_Type>* p)
+{
+    typename Probing::Sequence s(p->get_hash(), _size);
+    unsigned visited = 1;
+
+    for(; !s.at_end() && hTable[*s]; ++s)
+        ++visited;
+
+    unsigned index = s.at_end() ? make_room(p->get_hash(), visited) : *s;
+
+    total_visited_slots += visited;
+
+    if(index == _size)
+        return false;
+
+    hTable[index] = p;
+    return true;
+}
+
+
+//Specialization of HashTable for integer keys hashed with int_hash
+#include "intHashTable.h"
+
+#endif // HASHTABLE_H_INCLUDED
@@ -0,0 +1,214 @@
+/*
+  Course: TND004, Lab 2
+  Description: hash functors to be used as template argument Hasher of class HashTable
+              A hasher returns the full hash value of a key, the table reduces it to a slot
+*/
+
+#ifndef HASHERS_H_INCLUDED
+#define HASHERS_H_INCLUDED
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+
+/* ********************************** *
+* wyhash primitives                   *
+* *********************************** */
+
+//Multiply a and b as 128 bits numbers
+//The low 64 bits are stored in a and the high 64 bits in b
+constexpr void wy_mum(uint64_t& a, uint64_t& b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = a;
+    r *= b;
+    a = (uint64_t) r;
+    b = (uint64_t) (r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t) a, lb = (uint32_t) b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+constexpr uint64_t wy_mix(uint64_t a, uint64_t b)
+{
+    wy_mum(a, b);
+    return a ^ b;
+}
+
+inline uint64_t wy_read8(const unsigned char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t wy_read4(const unsigned char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint64_t wy_read3(const unsigned char* p, size_t k)
+{
+    return (((uint64_t) p[0]) << 16) | (((uint64_t) p[k >> 1]) << 8) | p[k - 1];
+}
+
+
+//Hash len bytes starting at key
+//Port of wyhash (final version), public domain
+inline uint64_t wy_hash_bytes(const void* key, size_t len, uint64_t seed = 0)
+{
+    static const uint64_t secret[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                                        0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+    const unsigned char* p = (const unsigned char*) key;
+    uint64_t a, b;
+
+    seed ^= wy_mix(seed ^ secret[0], secret[1]);
+
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            a = (wy_read4(p) << 32) | wy_read4(p + ((len >> 3) << 2));
+            b = (wy_read4(p + len - 4) << 32) | wy_read4(p + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0)
+        {
+            a = wy_read3(p, len);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = len;
+
+        if (i > 48)
+        {
+            uint64_t see1 = seed, see2 = seed;
+
+            do
+            {
+                seed = wy_mix(wy_read8(p) ^ secret[1], wy_read8(p + 8) ^ seed);
+                see1 = wy_mix(wy_read8(p + 16) ^ secret[2], wy_read8(p + 24) ^ see1);
+                see2 = wy_mix(wy_read8(p + 32) ^ secret[3], wy_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            }
+            while (i > 48);
+
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16)
+        {
+            seed = wy_mix(wy_read8(p) ^ secret[1], wy_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = wy_read8(p + i - 16);
+        b = wy_read8(p + i - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    wy_mum(a, b);
+
+    return wy_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+
+/* ********************************** *
+* Hash functors                       *
+* *********************************** */
+
+//Fast hash for strings (wyhash)
+//Transparent: string, string_view, and const char* with the same characters have the same hash value
+struct wy_hash
+{
+    typedef void is_transparent;
+
+    size_t operator()(string_view s) const
+    {
+        return (size_t) wy_hash_bytes(s.data(), s.size());
+    }
+};
+
+
+//Hash for integer keys: the finalizer of MurmurHash3 (fmix64), a bijection on 64 bits
+//Every bit of the key affects every bit of the hash value, thus a table can use the low bits directly
+//HashTable is specialized for int_hash: integer keys are stored without Items (see intHashTable.h)
+struct int_hash
+{
+    constexpr size_t operator()(uint64_t x) const
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+
+        return (size_t) x;
+    }
+};
+
+
+//Hash for strings that can be computed at compile time: FNV-1a, followed by the finalizer of int_hash
+//since FNV-1a leaves the high bits poorly mixed
+//Transparent, used by Static_Table for tables built at compile time (see staticTable.h)
+struct fnv_hash
+{
+    typedef void is_transparent;
+
+    constexpr size_t operator()(string_view s) const
+    {
+        uint64_t h = 0xcbf29ce484222325ull;
+
+        for (char c : s)
+        {
+            h ^= (unsigned char) c;
+            h *= 0x100000001b3ull;
+        }
+
+        return int_hash()(h);
+    }
+};
+
+
+//Hash function for English words
+//Polynomial accumulation, the Horner's rule is used to compute the value
+//See pag. 213 of course book
+struct horner_hash
+{
+    typedef void is_transparent;
+
+    constexpr size_t operator()(string_view s) const
+    {
+        unsigned hashVal = 0;
+
+        for(unsigned i = 0; i < s.length(); i++)
+            hashVal = 37 * hashVal + s[i];
+
+        return hashVal;
+    }
+};
+
+#endif // HASHERS_H_INCLUDED
@@ -0,0 +1,698 @@
+/*
+  Course: TND004, Lab 2
+  Description: specialization of template class HashTable for integer keys hashed with int_hash
+              Keys and values are stored in two parallel arrays, no Item is created,
+              and an empty slot is marked by a sentinel key
+*/
+
+#ifndef INTHASHTABLE_H_INCLUDED
+#define INTHASHTABLE_H_INCLUDED
+
+#include "hashTable.h"
+#include "hashers.h"
+
+#include <limits>
+
+using namespace std;
+
+
+//Template class to represent an open addressing hash table of integer keys, using linear probing
+//Selected when the Hasher is int_hash, e.g. HashTable<uint64_t, int, int_hash>
+//
+//Slot i stores the key keys[i] and its value values[i]. An empty slot stores the key EMPTY_KEY,
+//the largest value of Key_Type. The item with key EMPTY_KEY, if any, is stored apart from the arrays
+//Removed keys do not leave deleted marks: the next keys of the cluster are shifted back (backward shift deletion)
+//
+//int_hash mixes all bits of the key, thus the number of slots is a power of two and
+//the home slot of a key is given by the low bits of its hash value (no division)
+//
+//Same interface as the general HashTable, with these differences:
+// - references returned by operator[] are invalidated by a re-hash, since the values are moved
+// - Key_Equal is not used, keys are compared with ==
+// - the Probing policy must be Linear_Probing
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+class HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>
+{
+    static_assert(is_integral<Key_Type>::value, "int_hash tables need integer keys");
+    static_assert(is_same<Probing, Linear_Probing>::value, "int_hash tables use linear probing");
+
+public:
+
+    //Key value marking the empty slots
+    static constexpr Key_Type EMPTY_KEY = numeric_limits<Key_Type>::max();
+
+    //Constructor to create a hash table
+    //table_size is number of slots in the table (next power of two is used)
+    HashTable(int table_size, const int_hash& f = int_hash(), const Key_Equal& = Key_Equal());
+
+    //Destructor
+    ~HashTable()
+    {
+        delete[] keys;
+        delete[] values;
+    }
+
+
+    //Return the load factor of the table, i.e. percentage of slots in use
+    double loadFactor() const
+    {
+        return (double) nItems / _size;
+    }
+
+    //Return number of items stored in the table
+    unsigned get_number_OF_items() const
+    {
+        return nItems;
+    }
+
+    //Return number of slots in the table
+    unsigned get_size() const
+    {
+        return _size;
+    }
+
+    //Return the load factor that triggers a re-hash
+    double get_max_load_factor() const
+    {
+        return max_load_factor;
+    }
+
+    //Set the load factor that triggers a re-hash to f, 0 < f <= Linear_Probing::MAX_LOAD
+    //The table is re-hashed now if it is already too full for f
+    void set_max_load_factor(double f);
+
+    //Re-hash, if needed, so that n items can be stored without any further re-hash
+    void reserve(unsigned n)
+    {
+        if(slots_for(n) > _size)
+            rehash(slots_for(n));
+    }
+
+    //Re-hash to the smallest table that stores the current items below the max load factor
+    void shrink_to_fit()
+    {
+        if(round_up(slots_for(nItems)) < _size)
+            rehash(slots_for(nItems));
+    }
+
+    //Return number of bytes used by the table: the arrays of keys and values
+    size_t memory_usage() const
+    {
+        return _size * (sizeof(Key_Type) + sizeof(Value_Type));
+    }
+
+    //Return the total number of visited slots (during search, insert, remove, or re-hash)
+    unsigned get_total_visited_slots() const
+    {
+        return total_visited_slots;
+    }
+
+    //Return the total number of Items created, none since the keys are stored in place
+    unsigned get_count_new_items() const
+    {
+        return 0;
+    }
+
+    //Return the number of memory allocations done for the arrays of keys and values
+    unsigned get_count_allocations() const
+    {
+        return count_allocations;
+    }
+
+
+    //Return a pointer to the value associated with key
+    //If key does not exist in the table then nullptr is returned
+    const Value_Type* _find(const Key_Type& key)
+    {
+        return find_hashed(key, h(key));
+    }
+
+    //Insert the Item (key, v) in the table
+    //If key already exists in the table then change the value associated with key to v
+    void _insert(const Key_Type& key, const Value_Type& v)
+    {
+        insert_hashed(key, v, h(key));
+    }
+
+    //Remove Item with key, if the item exists
+    //If an Item was removed then return true
+    //otherwise, return false
+    bool _remove(const Key_Type& key)
+    {
+        return remove_hashed(key, h(key));
+    }
+
+    //Overloaded subscript operator
+    //If key is not in the table then insert a new Item = (key, Value_Type())
+    Value_Type& operator[](const Key_Type& key)
+    {
+        return subscript_hashed(key, h(key));
+    }
+
+
+    //Batch operations on the n keys in array keys, see HashTable
+    void find_many(const Key_Type keys[], unsigned n, const Value_Type* values[]);
+
+    void insert_many(const Key_Type keys[], const Value_Type values[], unsigned n);
+
+    void increment_many(const Key_Type keys[], unsigned n);
+
+
+    //Display all items in table T to stream os
+    friend ostream& operator<<(ostream& os, const HashTable& T)
+    {
+        T.for_each([&os](const Key_Type& key, const Value_Type& v)
+        {
+            os << Item<Key_Type, Value_Type>(key, v) << '\n';
+        });
+
+        return os;
+    }
+
+    //Call f(key, value) for every item in the table, in slot order
+    //The item with key EMPTY_KEY, if any, is the last one
+    template <typename Function>
+    void for_each(Function f) const
+    {
+        for_each_hashed([&f](const Key_Type& key, const Value_Type& v, size_t) { f(key, v); });
+    }
+
+    //Call f(key, value, hv) for every item in the table, in slot order
+    template <typename Function>
+    void for_each_hashed(Function f) const;
+
+    //Return the hash function object
+    const int_hash& hash_function() const
+    {
+        return h;
+    }
+
+
+    //Add the value of each item in T to the value associated with the same key in this table
+    void merge(const HashTable& T)
+    {
+        reserve(max(nItems, T.nItems));
+
+        T.for_each_hashed([this](const Key_Type& key, const Value_Type& v, size_t hv)
+        {
+            subscript_hashed(key, hv) += v;
+        });
+    }
+
+
+    //Return the statistics recorded by the Stats policy
+    const Stats& get_stats() const
+    {
+        return stats;
+    }
+
+    //Scan the table and return its occupancy (see HashTable::analyze)
+    //S.items counts the slots in use: the item with key EMPTY_KEY, stored apart, is not counted
+    Table_Shape analyze() const;
+
+    //Display the table for debug and testing purposes
+    void display(ostream& os);
+
+
+private:
+
+    //Shards of a Concurrent_HashTable share the hash value computed to select the shard
+    template <typename, typename, typename, typename>
+    friend class Concurrent_HashTable;
+
+    /* ********************************** *
+    * Data members                        *
+    * *********************************** */
+
+    //Number of slots in the table, a power of two
+    unsigned _size;
+
+    //Hash function object
+    const int_hash h;
+
+    //Number of items stored in the table, including the item with key EMPTY_KEY
+    unsigned nItems;
+
+    //Always 0, there are no deleted slots (used by Concurrent_HashTable::loadFactor)
+    static constexpr unsigned nDeleted = 0;
+
+    //The table is re-hashed when its load factor reaches max_load_factor
+    double max_load_factor;
+
+    //Parallel arrays of keys and values
+    Key_Type* keys;
+    Value_Type* values;
+
+    //The item with key EMPTY_KEY
+    bool has_empty_key;
+    Value_Type empty_key_value;
+
+    //Some statistics
+    unsigned total_visited_slots;  //total number of visited slots
+    unsigned count_allocations;    //number of arrays allocated
+
+    //Instrumentation policy
+    Stats stats;
+
+
+    /* ********************************** *
+    * Auxiliar member functions           *
+    * *********************************** */
+
+    const Value_Type* find_hashed(const Key_Type& key, size_t hv);
+
+    void insert_hashed(const Key_Type& key, const Value_Type& v, size_t hv)
+    {
+        subscript_hashed(key, hv) = v;
+    }
+
+    bool remove_hashed(const Key_Type& key, size_t hv);
+
+    Value_Type& subscript_hashed(const Key_Type& key, size_t hv);
+
+    //Return the slot storing key, whose hash value is hv, key != EMPTY_KEY
+    //If key is not in the table then the empty slot where key should be inserted is returned
+    //found is set to true if and only if key is in the table
+    //The probe length is reported to stats as an operation op
+    unsigned probe(const Key_Type& key, size_t hv, bool& found, Table_Operation op);
+
+    //Return the home slot of the hash value hv
+    unsigned home(size_t hv) const
+    {
+        return (unsigned) hv & (_size - 1);
+    }
+
+    //Return number of slots needed to store n items below the max load factor
+    unsigned slots_for(unsigned n) const
+    {
+        return (unsigned) (n / max_load_factor) + 1;
+    }
+
+    //Return the smallest power of two >= n
+    static unsigned round_up(unsigned n)
+    {
+        unsigned p = 2;
+
+        while(p < n)
+            p *= 2;
+
+        return p;
+    }
+
+    //Allocate the arrays for _size slots, all empty
+    void allocate();
+
+    //Re-hash to a table of at least n_slots slots (next power of two is used)
+    void rehash(unsigned n_slots);
+
+    //Disable copy constructor!!
+    HashTable(const HashTable &) = delete;
+
+    //Disable assignment operator!!
+    const HashTable& operator=(const HashTable &) = delete;
+};
+
+
+/* ********************************** *
+* Member functions implementation     *
+* *********************************** */
+
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::HashTable(int table_size, const int_hash& f,
+                                                                               const Key_Equal&)
+    : h(f)
+{
+    _size = round_up(max(table_size, 2));
+    nItems = 0;
+    max_load_factor = MAX_LOAD_FACTOR;
+    has_empty_key = false;
+    empty_key_value = Value_Type();
+    total_visited_slots = 0;
+    count_allocations = 0;
+    allocate();
+}
+
+
+//Set the load factor that triggers a re-hash to f
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+void HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::set_max_load_factor(double f)
+{
+    //at least one slot must stay empty, so that probing stops
+    max_load_factor = min(max(f, 0.01), Linear_Probing::MAX_LOAD);
+
+    if(loadFactor() >= max_load_factor)
+        rehash(slots_for(nItems + 1));
+}
+
+
+//values[i] is set to _find(keys[i])
+//The home slots of a group of keys are prefetched before the first key is searched
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+void HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::find_many(const Key_Type _keys[], unsigned n,
+                                                                                    const Value_Type* _values[])
+{
+    size_t hv[PREFETCH_BATCH];
+
+    for(unsigned first = 0; first < n; first += PREFETCH_BATCH)
+    {
+        unsigned m = min(PREFETCH_BATCH, n - first);
+
+        for(unsigned i = 0; i < m; ++i)
+        {
+            hv[i] = h(_keys[first + i]);
+            prefetch(&keys[home(hv[i])]);
+            prefetch(&values[home(hv[i])]);
+        }
+
+        for(unsigned i = 0; i < m; ++i)
+            _values[first + i] = find_hashed(_keys[first + i], hv[i]);
+    }
+}
+
+
+//_insert(keys[i], values[i]) for i = 0, ..., n-1
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+void HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::insert_many(const Key_Type _keys[],
+                                                                                      const Value_Type _values[],
+                                                                                      unsigned n)
+{
+    size_t hv[PREFETCH_BATCH];
+
+    for(unsigned first = 0; first < n; first += PREFETCH_BATCH)
+    {
+        unsigned m = min(PREFETCH_BATCH, n - first);
+
+        for(unsigned i = 0; i < m; ++i)
+        {
+            hv[i] = h(_keys[first + i]);
+            prefetch(&keys[home(hv[i])]);
+        }
+
+        for(unsigned i = 0; i < m; ++i)
+            insert_hashed(_keys[first + i], _values[first + i], hv[i]);
+    }
+}
+
+
+//++operator[](keys[i]) for i = 0, ..., n-1
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+void HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::increment_many(const Key_Type _keys[],
+                                                                                         unsigned n)
+{
+    size_t hv[PREFETCH_BATCH];
+
+    for(unsigned first = 0; first < n; first += PREFETCH_BATCH)
+    {
+        unsigned m = min(PREFETCH_BATCH, n - first);
+
+        for(unsigned i = 0; i < m; ++i)
+        {
+            hv[i] = h(_keys[first + i]);
+            prefetch(&keys[home(hv[i])]);
+            prefetch(&values[home(hv[i])]);
+        }
+
+        for(unsigned i = 0; i < m; ++i)
+            ++subscript_hashed(_keys[first + i], hv[i]);
+    }
+}
+
+
+//Call f(key, value, hv) for every item in the table, in slot order
+//The hash values are re-computed, int_hash is a few instructions
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+template <typename Function>
+void HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::for_each_hashed(Function f) const
+{
+    for(unsigned i = 0; i < _size; ++i)
+    {
+        if(keys[i] != EMPTY_KEY)
+            f(keys[i], values[i], h(keys[i]));
+    }
+
+    if(has_empty_key)
+        f(EMPTY_KEY, empty_key_value, h(EMPTY_KEY));
+}
+
+
+//Scan the table and return its occupancy
+//The displacement of an item is the number of slots between its home slot and its slot
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+Table_Shape HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::analyze() const
+{
+    Table_Shape S;
+    vector<size_t> hashes;
+
+    S.size = _size;
+    hashes.reserve(nItems);
+
+    //the table is never full, start after an empty slot so that no cluster wraps around
+    unsigned start = 0;
+
+    while(keys[start] != EMPTY_KEY)
+        ++start;
+
+    unsigned run = 0;
+
+    for(unsigned k = 1; k <= _size; ++k)
+    {
+        unsigned i = (start + k) & (_size - 1);
+
+        if(keys[i] == EMPTY_KEY)
+        {
+            if(run)
+                S.clusters.add(run);
+            run = 0;
+            continue;
+        }
+
+        size_t hv = h(keys[i]);
+
+        ++run;
+        ++S.items;
+        S.displacement.add((i - home(hv)) & (_size - 1));
+        hashes.push_back(hv);
+    }
+
+    //int_hash is a bijection on 64 bits, but the hash value is truncated when size_t is smaller
+    sort(hashes.begin(), hashes.end());
+
+    for(unsigned i = 0; i < hashes.size(); ++i)
+    {
+        if((i > 0 && hashes[i] == hashes[i - 1]) || (i + 1 < hashes.size() && hashes[i] == hashes[i + 1]))
+            ++S.equal_hashes;
+    }
+
+    S.expected_displacement = Linear_Probing::expected_displacement((double) S.items / _size);
+
+    return S;
+}
+
+
+//Display the table for debug and testing purposes
+//Thus, empty entries are also displayed
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+void HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::display(ostream& os)
+{
+    os << "-------------------------------\n";
+    os << "Number of items in the table: " << get_number_OF_items() << endl;
+    os << "Load factor: " << fixed << setprecision(2) << loadFactor() << endl;
+
+    for (unsigned i = 0; i < _size; ++i)
+    {
+        os << setw(6) << i << ": ";
+
+        if(keys[i] == EMPTY_KEY)
+        {
+            os << "null" << endl;
+        }
+        else
+        {
+            os << Item<Key_Type, Value_Type>(keys[i], values[i])
+               << "  (" << home(h(keys[i])) << ")" << endl;
+        }
+    }
+
+    if(has_empty_key)
+        os << setw(6) << "-" << ": " << Item<Key_Type, Value_Type>(EMPTY_KEY, empty_key_value) << endl;
+
+    os << endl;
+}
+
+
+/* ********************************** *
+* Auxiliar member functions           *
+* *********************************** */
+
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+const Value_Type* HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::find_hashed(const Key_Type& key,
+                                                                                                   size_t hv)
+{
+    if(key == EMPTY_KEY)
+        return has_empty_key ? &empty_key_value : nullptr;
+
+    bool found;
+    unsigned index = probe(key, hv, found, FIND_OP);
+
+    return found ? &values[index] : nullptr;
+}
+
+
+//The keys after the removed one, up to the next empty slot, are moved back
+//unless the removed slot is before their home slot
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+bool HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::remove_hashed(const Key_Type& key, size_t hv)
+{
+    if(key == EMPTY_KEY)
+    {
+        if(!has_empty_key)
+            return false;
+
+        has_empty_key = false;
+        empty_key_value = Value_Type();
+        --nItems;
+        return true;
+    }
+
+    bool found;
+    unsigned hole = probe(key, hv, found, REMOVE_OP);
+
+    if(!found)
+        return false;
+
+    const unsigned mask = _size - 1;
+
+    for(unsigned j = (hole + 1) & mask; keys[j] != EMPTY_KEY; j = (j + 1) & mask)
+    {
+        ++total_visited_slots;
+
+        //keys[j] can be moved to the hole if the hole is between its home slot and j
+        if(((j - home(h(keys[j]))) & mask) >= ((j - hole) & mask))
+        {
+            keys[hole] = keys[j];
+            values[hole] = move(values[j]);
+            hole = j;
+        }
+    }
+
+    keys[hole] = EMPTY_KEY;
+    values[hole] = Value_Type();
+    --nItems;
+    return true;
+}
+
+
+//The table is re-hashed before a new key is inserted, so that the returned reference stays valid
+//until the next insertion
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+Value_Type& HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::subscript_hashed(const Key_Type& key,
+                                                                                                  size_t hv)
+{
+    if(key == EMPTY_KEY)
+    {
+        if(!has_empty_key)
+        {
+            has_empty_key = true;
+            ++nItems;
+        }
+
+        return empty_key_value;
+    }
+
+    bool found;
+    unsigned index = probe(key, hv, found, INSERT_OP);
+
+    if(found)
+        return values[index];
+
+    if((double) (nItems + 1) / _size >= max_load_factor)
+    {
+        rehash(_size * 2);
+        index = probe(key, hv, found, INSERT_OP);
+    }
+
+    keys[index] = key;
+    ++nItems;
+
+    return values[index];
+}
+
+
+//Linear probing starting at the home slot of key
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+unsigned HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::probe(const Key_Type& key, size_t hv,
+                                                                                    bool& found, Table_Operation op)
+{
+    unsigned index = home(hv);
+    unsigned length = 1; //slots visited
+
+    //The table is never full (max_load_factor < 1), so the loop stops at an empty slot
+    for(; keys[index] != EMPTY_KEY && keys[index] != key; ++length)
+        index = (index + 1) & (_size - 1);
+
+    found = keys[index] != EMPTY_KEY;
+
+    total_visited_slots += length;
+    stats.on_probe(op, length);
+
+    return index;
+}
+
+
+//Values of the empty slots are Value_Type()
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+void HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::allocate()
+{
+    keys = new Key_Type[_size];
+    values = new Value_Type[_size]();
+    count_allocations += 2;
+
+    for(unsigned i = 0; i < _size; ++i)
+    {
+        keys[i] = EMPTY_KEY;
+    }
+}
+
+
+//Keys are moved to the new arrays with their re-computed hash values
+template <typename Key_Type, typename Value_Type, typename Key_Equal, typename Stats, typename Probing>
+void HashTable<Key_Type, Value_Type, int_hash, Key_Equal, Stats, Probing>::rehash(unsigned n_slots)
+{
+    chrono::steady_clock::time_point start;
+
+    if constexpr (Stats::enabled)
+        start = chrono::steady_clock::now();
+
+    unsigned old_size = _size;
+    Key_Type* oldKeys = keys;
+    Value_Type* oldValues = values;
+
+    _size = round_up(n_slots);
+    allocate();
+
+    for(unsigned idt = 0; idt < old_size; ++idt)
+    {
+        if(oldKeys[idt] == EMPTY_KEY)
+            continue;
+
+        unsigned index = home(h(oldKeys[idt]));
+
+        while(keys[index] != EMPTY_KEY)
+        {
+            ++total_visited_slots;
+            index = (index + 1) & (_size - 1);
+        }
+        ++total_visited_slots;
+
+        keys[index] = oldKeys[idt];
+        values[index] = move(oldValues[idt]);
+    }
+
+    delete[] oldKeys;
+    delete[] oldValues;
+
+    if constexpr (Stats::enabled)
+        stats.on_rehash(old_size, _size, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+}
+
+#endif // INTHASHTABLE_H_INCLUDED
@@ -8,111 +8,765 @@
 #include <iostream>
 #include <string>
 #include <iomanip>
+#include <thread>
+#include <vector>
 #include <algorithm>
-#include <fstream>
-#include <random>
+#include <memory>
+#include <cstdio>
+#include <stdexcept>
 
 #include "hashTable.h"
+#include "wordCount.h"
+#include "mappedFile.h"
+#include "report.h"
+#include "sketch.h"
+#include "snapshot.h"
+#include "pipeline.h"
+#include "partial.h"
 
 using namespace std;
 
 const unsigned SEED = 1159241;
 
-const string PUNCT = ".,!?:\"();";
 
+//Options given in the command line (see main)
+struct Options
+{
+    vector<string> names;
+    string out_name;
+    unsigned n_threads = 1;
+    unsigned k = 10;
+    unsigned long interval = 0;
+    string report = "table";
+    bool approximate = false;
+    double eps = 0.001;
+    double delta = 0.01;
+    string snapshot_name;  //-s
+    string query_name;     //-q
+    bool verbose = false;  //-v
+    unsigned expected_words = 0;               //-n
+    double max_load_factor = MAX_LOAD_FACTOR;  //-l
+    string probing = "linear";                 //-p
+    unsigned pipeline = 0;                     //-P
+    string partial_name;                       //-w
+    bool merge = false;                        //-m
+    bool shared = false;                       //-c
+};
+
+
+//Count the words in the input files into T, display the statistics and write the report
+//Return false if a file could not be opened
+template <typename Table>
+bool count_and_report(Table& T, const Options& opt);
+
+//Count the words exactly, in a hash table resolving collisions with the policy Probing
+template <typename Probing>
+void count_exact(const Options& opt);
+
+//Count the words exactly, all threads adding to one Concurrent_HashTable
+void count_shared(const Options& opt);
+
+//Merge the partial count files in opt.names and write the report
+//Return false if a file could not be read or written
+bool merge_and_report(const Options& opt);
+
+//Display the frequency of each word in words, searched in the snapshot file name
+void query_snapshot(ostream& os, const string& name, const vector<string>& words);
+
+//Count the words in the text [begin, end) into T
+template <typename Probing>
+Count_Stats count_text(const char* begin, const char* end, unsigned n_threads, Word_Table<Probing>& T);
+Count_Stats count_text(const char* begin, const char* end, unsigned n_threads, Heavy_Hitters& T);
+Count_Stats count_text(const char* begin, const char* end, unsigned n_threads, Shared_Freq_Table& T);
+
+//Display the statistics of the table T, filled with the words counted in stats
+template <typename Probing>
+void display_stats(ostream& os, const Word_Table<Probing>& T, const Count_Stats& stats);
+void display_stats(ostream& os, const Heavy_Hitters& T, const Count_Stats& stats);
+void display_stats(ostream& os, const Shared_Freq_Table& T, const Count_Stats& stats);
+
+//Display the statistics of the shared table T, filled with the words counted in stats
+//The statistics are added up over the shards of T
+void display_stats(ostream& os, const Shared_Freq_Table& T, const Count_Stats& stats)
+{
+    unsigned long _count = stats.words;
+    unsigned long total = stats.visited_slots;
+
+    os << "\nNumber of words in the file = " << _count << endl;
+
+    os << "Number unique  words in the file = "
+       << T.get_number_OF_items() << endl;
+
+    os << "\nNumber of shards = "
+       << T.get_number_OF_shards() << endl;
+
+    os << "Table's load factor = "
+       << fixed << setprecision(2) << T.loadFactor() << endl;
 
-//Hash function for English words
-//Polynomial accumulation
-//the Horner's rule is used to compute the value
-//See pag. 213 of course book
-unsigned _hash(string s, int tableSize);
+    os << "Number of Items created = "
+       << T.get_count_new_items() << endl;
 
-int main()
+    os << "Memory used by the table = "
+       << T.memory_usage() << " bytes" << endl << endl;
+
+    os << "\nNumber of slots visited = "
+       << total << endl;
+
+    os << "Average Number of slots visited = "
+       << fixed << setprecision(2) << (double)total / _count << endl;
+}
+
+
+//Display the occupancy of T and, if compiled with TABLE_STATS, its probe statistics
+template <typename Probing>
+void display_instrumentation(ostream& os, const Word_Table<Probing>& T);
+
+//Display the k most frequent words in T
+template <typename Table>
+void display_top_k(ostream& os, const Table& T, unsigned k);
+
+//Write the frequency table T to out, as requested by report (see main)
+template <typename Table>
+void write_report(Buffered_Writer& out, const Table& T, const string& report, unsigned k);
+
+//Display that the value of an option is not a valid number, and the usage
+//Return the exit status of the program
+int bad_number(const string& value);
+
+
+//Usage: TND004Lab2 [-t threads] [-k K] [-i words] [-o output] [-a] [-e eps] [-d delta] [file name | -] ...
+//-t 0 uses one thread per hardware thread
+//Each thread counts a part of the text into its own table, the tables are merged at the end
+//-c: the threads count into one table shared by all of them, a Concurrent_HashTable (see concurrentHashTable.h)
+//   -p and -l are not used, -s and -w cannot be given
+//If no file name is given then it is read from cin
+//
+//Streaming mode is used when reading from stdin (file name -), from several files, or with -i or -P
+//The input is read in chunks with bounded memory, the files do not need to be seekable
+//-i words: display the K (-k, default 10) most frequent words every time about that many words were read
+//-P tokenizers: pipelined streaming mode, a reader thread, that many tokenizer threads, and a counter thread
+//   are connected by bounded ring buffers (see pipeline.h), the throughput of each stage is displayed
+//   -t is not used
+//-o output: the frequency table is written to output (default out_stream.txt)
+//
+//-r report: what is written to the output file
+//   table   all words in table order (default)
+//   sorted  all words sorted by decreasing frequency
+//   top     the K most frequent words, sorted by decreasing frequency
+//
+//-a: approximate mode, the words are counted in fixed memory with a Heavy_Hitters table (see sketch.h)
+//instead of a HashTable, only the most frequent words are kept
+//The counts are at most eps * (number of words) too large (-e, default 0.001),
+//with probability 1 - delta (-d, default 0.01)
+//The approximate mode uses one thread, -s and -w cannot be given
+//
+//-s snapshot: write a binary snapshot of the frequency table to the file snapshot (see snapshot.h)
+//-q snapshot word ...: display the frequency of each word, searched in the file snapshot
+//   The words are not counted and no output file is written
+//
+//-w partial: write the frequency table to the partial count file partial (see partial.h)
+//-m partial ...: merge mode, the file names are partial count files written with -w, e.g. by several
+//   processes each counting a shard of the input, which are merged in a single pass
+//   The report (-r) of the merged counts is written to the output file (default out_merge.txt),
+//   with -r top only the K most frequent words are kept in memory, unless -s is given
+//   -w and -s write the merged counts to a partial file or a snapshot
+//
+//-n words: reserve room in the hash table for that many distinct words, so that it is not re-hashed
+//-l load: maximum load factor of the hash table (default 0.5)
+//-p policy: collision resolution of the hash table (see probing.h)
+//   linear     linear probing (default)
+//   quadratic  quadratic probing, the load factor is at most 0.5
+//   double     double hashing
+//   cuckoo     bucketized cuckoo hashing, buckets of 4 slots, the load factor is at most 0.9
+//
+//-v: display the occupancy of the hash table (clusters, displacement, tombstones, hash quality)
+//    and, if compiled with -DTABLE_STATS, the probe length histograms and re-hash times
+int main(int argc, char* argv[])
 {
-    HashTable<string,int> freq_table(100, _hash);
+    Options opt;
+    int i = 1;
 
-    string name;
+    try
+    {
+        for (; i < argc; ++i)
+        {
+            string arg = argv[i];
+
+            if (arg == "-t" && i + 1 < argc)
+            {
+                opt.n_threads = stoul(argv[++i]);
+
+                if (opt.n_threads == 0)
+                    opt.n_threads = max(1u, thread::hardware_concurrency());
+            }
+            else if (arg == "-k" && i + 1 < argc)
+            {
+                opt.k = stoul(argv[++i]);
+            }
+            else if (arg == "-i" && i + 1 < argc)
+            {
+                opt.interval = stoul(argv[++i]);
+            }
+            else if (arg == "-o" && i + 1 < argc)
+            {
+                opt.out_name = argv[++i];
+            }
+            else if (arg == "-r" && i + 1 < argc)
+            {
+                opt.report = argv[++i];
+            }
+            else if (arg == "-a")
+            {
+                opt.approximate = true;
+            }
+            else if (arg == "-e" && i + 1 < argc)
+            {
+                opt.eps = stod(argv[++i]);
+            }
+            else if (arg == "-d" && i + 1 < argc)
+            {
+                opt.delta = stod(argv[++i]);
+            }
+            else if (arg == "-s" && i + 1 < argc)
+            {
+                opt.snapshot_name = argv[++i];
+            }
+            else if (arg == "-q" && i + 1 < argc)
+            {
+                opt.query_name = argv[++i];
+            }
+            else if (arg == "-v")
+            {
+                opt.verbose = true;
+            }
+            else if (arg == "-n" && i + 1 < argc)
+            {
+                opt.expected_words = stoul(argv[++i]);
+            }
+            else if (arg == "-l" && i + 1 < argc)
+            {
+                opt.max_load_factor = stod(argv[++i]);
+            }
+            else if (arg == "-p" && i + 1 < argc)
+            {
+                opt.probing = argv[++i];
+            }
+            else if (arg == "-P" && i + 1 < argc)
+            {
+                opt.pipeline = max(1ul, stoul(argv[++i]));
+            }
+            else if (arg == "-w" && i + 1 < argc)
+            {
+                opt.partial_name = argv[++i];
+            }
+            else if (arg == "-m")
+            {
+                opt.merge = true;
+            }
+            else if (arg == "-c")
+            {
+                opt.shared = true;
+            }
+            else
+            {
+                opt.names.push_back(arg);
+            }
+        }
+    }
+    catch (const invalid_argument&)
+    {
+        return bad_number(argv[i]);
+    }
+    catch (const out_of_range&)
+    {
+        return bad_number(argv[i]);
+    }
 
-    cout << "Enter file name: ";
-    cin >> name;
+    if (!opt.query_name.empty())
+    {
+        query_snapshot(cout, opt.query_name, opt.names);
 
-    ifstream file_in(name);
-    ofstream file_out("out_"+name);
+        return 0;
+    }
 
-    if (!file_in || !file_out)
+    if (opt.names.empty())
     {
-        cout << "Could not open a file!!" << endl;
+        string name;
+
+        cout << "Enter file name: ";
+        cin >> name;
+        opt.names.push_back(name);
+    }
+
+    if (opt.eps <= 0 || opt.eps >= 1 || opt.delta <= 0 || opt.delta >= 1)
+    {
+        cout << "eps and delta must be in (0, 1)!!" << endl;
+
+        return 0;
+    }
+
+    if (!opt.merge && (opt.approximate || opt.shared) && (!opt.snapshot_name.empty() || !opt.partial_name.empty()))
+    {
+        cout << "-s and -w cannot be used with " << (opt.approximate ? "-a" : "-c") << "!!" << endl;
 
         return 0;
     }
 
-    string s;
-    int _count = 0;
+    if (opt.merge)
+    {
+        merge_and_report(opt);
+    }
+    else if (opt.approximate)
+    {
+        Heavy_Hitters approx_table(opt.eps, opt.delta);
+
+        count_and_report(approx_table, opt);
+    }
+    else if (opt.shared)
+        count_shared(opt);
+    else if (opt.probing == "linear")
+        count_exact<Linear_Probing>(opt);
+    else if (opt.probing == "quadratic")
+        count_exact<Quadratic_Probing>(opt);
+    else if (opt.probing == "double")
+        count_exact<Double_Hashing>(opt);
+    else if (opt.probing == "cuckoo")
+        count_exact<Cuckoo_Hashing<> >(opt);
+    else
+        cout << "Unknown probing policy!!" << endl;
+
+    return 0;
+}
+
+
+//Display that the value of an option is not a valid number, and the usage
+int bad_number(const string& value)
+{
+    cout << "Invalid number: " << value << "!!\n\n"
+         << "Usage: TND004Lab2 [-t threads] [-c] [-k K] [-i words] [-P tokenizers] [-o output]\n"
+         << "                  [-r table|sorted|top] [-a] [-e eps] [-d delta] [-s snapshot] [-w partial]\n"
+         << "                  [-n words] [-l load] [-p linear|quadratic|double|cuckoo] [-v] [file name | -] ...\n"
+         << "       TND004Lab2 -q snapshot word ...\n"
+         << "       TND004Lab2 -m [-r report] [-k K] [-o output] [-s snapshot] [-w partial] partial ..." << endl;
+
+    return 1;
+}
+
+
+//Count the words in the input files into T, display the statistics and write the report
+template <typename Table>
+bool count_and_report(Table& T, const Options& opt)
+{
+    const vector<string>& names = opt.names;
+    bool streaming = names.size() > 1 || opt.interval > 0 || opt.pipeline > 0 ||
+                     find(names.begin(), names.end(), "-") != names.end();
+    string out_name = opt.out_name;
+
+    if (out_name.empty())
+        out_name = streaming ? "out_stream.txt" : "out_" + names[0];
+
+    FILE* file_out = fopen(out_name.c_str(), "w");
+
+    if (!file_out)
+    {
+        cout << "Could not open a file!!" << endl;
+
+        return false;
+    }
+
+    Count_Stats stats;
+    Pipeline_Stats pipeline_stats;
 
-    //Read words and load them in the hash table
-    while (file_in >> s)
+    if (!streaming)
     {
-        //transform all upper-case letters to lower-case letters
-        transform(s.begin(), s.end(), s.begin(), ::tolower);
+        //The file is memory mapped, if possible, thus it is not copied
+        Mapped_File file_in(names[0]);
+
+        if (!file_in.is_open())
+        {
+            cout << "Could not open a file!!" << endl;
+            fclose(file_out);
 
-        string s1;
+            return false;
+        }
 
-        copy_if(s.begin(), s.end(), back_inserter(s1), [](char c)
+        //Read words and load them in the table
+        stats = count_text(file_in.begin(), file_in.end(), opt.n_threads, T);
+    }
+    else
+    {
+        unsigned long next_report = opt.interval;
+
+        for (const string& name : names)
         {
-            return (PUNCT.find(c) == string::npos);
-        });
+            FILE* f = (name == "-") ? stdin : fopen(name.c_str(), "rb");
+
+            if (!f)
+            {
+                cout << "Could not open a file!!" << endl;
+                fclose(file_out);
+
+                return false;
+            }
+
+            Count_Stats before = stats;
+
+            auto count = [&](const char* begin, const char* end)
+            {
+                return count_text(begin, end, opt.n_threads, T);
+            };
+
+            auto report = [&](const Count_Stats& s)
+            {
+                stats = before;
+                stats += s;
+
+                if (opt.interval > 0 && stats.words >= next_report)
+                {
+                    cout << "\nAfter " << stats.words << " words:\n";
+                    display_top_k(cout, T, opt.k);
+                    cout << flush;
+
+                    next_report = stats.words + opt.interval;
+                }
+            };
+
+            //Read words and load them in the table, chunk by chunk
+            if (opt.pipeline > 0)
+                count_pipelined(f, T, opt.pipeline, pipeline_stats, report);
+            else
+                count_stream(f, count, report);
+
+            if (f != stdin)
+                fclose(f);
+        }
+    }
 
-        //if s is not in the table then it is inserted
-        freq_table[s1]++;
+    display_stats(cout, T, stats);
 
-        _count++;
+    if (opt.pipeline > 0)
+        cout << "\nPipeline stages:\n" << pipeline_stats;
+
+
+    {
+        Buffered_Writer out(file_out);
+
+        write_report(out, T, opt.report, opt.k);
     }
 
-    unsigned total = freq_table.get_total_visited_slots();
+    //close the output file
+    fclose(file_out);
+
+    return true;
+}
+
+
+//Count the words exactly, in a hash table resolving collisions with the policy Probing
+template <typename Probing>
+void count_exact(const Options& opt)
+{
+    Word_Table<Probing> freq_table(100);
 
-    cout << "\nNumber of words in the file = " << _count << endl;
+    freq_table.set_max_load_factor(opt.max_load_factor);
+    freq_table.reserve(opt.expected_words);
 
-    cout << "Number unique  words in the file = "
-         << freq_table.get_number_OF_items() << endl;
+    if (!count_and_report(freq_table, opt))
+        return;
 
-    cout << "\nTable's load factor = "
-         << fixed << setprecision(2) << freq_table.loadFactor() << endl;
+    if (opt.verbose)
+        display_instrumentation(cout, freq_table);
 
-    cout << "Number of calls to new Item() = "
-         << freq_table.get_count_new_items() << endl << endl;
+    if (!opt.snapshot_name.empty() && !save_snapshot(freq_table, opt.snapshot_name))
+        cout << "Could not write the snapshot!!" << endl;
 
-    cout << "\nNumber of slots visited = "
-         << total << endl;
+    if (!opt.partial_name.empty() && !save_partial(freq_table, opt.partial_name))
+        cout << "Could not write the partial file!!" << endl;
+}
 
-    cout << "Average Number of slots visited = "
-         << fixed << setprecision(2) << (double)total / _count << endl;
 
+//Count the words exactly, all threads adding to one Concurrent_HashTable
+void count_shared(const Options& opt)
+{
+    Shared_Freq_Table freq_table(100);
 
-    file_out << "Frequency table ..." << endl << endl;
+    freq_table.reserve(opt.expected_words);
 
-    file_out << freq_table << endl;
+    count_and_report(freq_table, opt);
+}
 
 
-    //close the file streams
-    file_in.close();
-    file_out.close();
+//Merge the partial count files in opt.names and write the report
+//The merged counts are only stored in a table when the report or the snapshot needs all of them
+//The files are read once: the merged partial file (-w) is written by the same merge that feeds the report
+bool merge_and_report(const Options& opt)
+{
+    const vector<string>& names = opt.names;
+    string out_name = opt.out_name.empty() ? "out_merge.txt" : opt.out_name;
+    unique_ptr<Partial_Writer<int> > partial_out;
 
-    return 0;
+    if (!opt.partial_name.empty())
+    {
+        partial_out.reset(new Partial_Writer<int>(opt.partial_name));
+
+        if (!partial_out->is_open())
+        {
+            cout << "Could not open a file!!" << endl;
+
+            return false;
+        }
+    }
+
+    FILE* file_out = fopen(out_name.c_str(), "w");
+
+    if (!file_out)
+    {
+        cout << "Could not open a file!!" << endl;
+
+        return false;
+    }
+
+    unsigned long _count = 0;
+    unsigned long n_unique = 0;
+    bool ok;
+
+    {
+        Buffered_Writer out(file_out);
+
+        if (opt.report == "top" && opt.snapshot_name.empty())
+        {
+            Top_K<string, unsigned long> top(opt.k);
+
+            ok = merge_partials<int>(names, [&](string_view key, int v)
+            {
+                if (top.selects(key, v))
+                    top.add(string(key), v);
+
+                if (partial_out)
+                    partial_out->add(key, v);
+
+                _count += v;
+                ++n_unique;
+            });
+
+            out << "Top " << opt.k << " words ...\n\n";
+
+            for (const auto& e : top.sorted())
+                write_item(out, e.first, e.second);
+
+            out << '\n';
+        }
+        else
+        {
+            Freq_Table freq_table(100);
+
+            freq_table.set_max_load_factor(opt.max_load_factor);
+            freq_table.reserve(opt.expected_words);
+
+            ok = merge_partials<int>(names, [&](string_view key, int v)
+            {
+                freq_table._insert(key, v);
+
+                if (partial_out)
+                    partial_out->add(key, v);
+
+                _count += v;
+            });
+
+            n_unique = freq_table.get_number_OF_items();
+            write_report(out, freq_table, opt.report, opt.k);
+
+            if (ok && !opt.snapshot_name.empty() && !save_snapshot(freq_table, opt.snapshot_name))
+                cout << "Could not write the snapshot!!" << endl;
+        }
+    }
+
+    fclose(file_out);
+
+    if (!ok)
+    {
+        cout << "Could not merge the partial files!!" << endl;
+
+        return false;
+    }
+
+    if (partial_out && !partial_out->close())
+        cout << "Could not write the partial file!!" << endl;
+
+    cout << "\nNumber of partial files merged = " << names.size() << endl;
+    cout << "Number of words in the files = " << _count << endl;
+    cout << "Number unique  words in the files = " << n_unique << endl;
+
+    return true;
+}
+
+
+//Display the frequency of each word in words, searched in the snapshot file name
+//The snapshot is memory mapped, the table is not rebuilt
+void query_snapshot(ostream& os, const string& name, const vector<string>& words)
+{
+    Snapshot_Table<int, wy_hash> snapshot(name);
+
+    if (!snapshot.is_open())
+    {
+        os << "Could not open a snapshot!!" << endl;
+
+        return;
+    }
+
+    for (const string& w : words)
+    {
+        const int* v = snapshot._find(w);
+
+        os << "key = \"" << w << "\"    value = " << (v ? *v : 0) << '\n';
+    }
+}
+
+
+//Count the words in the text [begin, end) into T
+template <typename Probing>
+Count_Stats count_text(const char* begin, const char* end, unsigned n_threads, Word_Table<Probing>& T)
+{
+    return count_words_parallel(begin, end, n_threads, T);
+}
+
+Count_Stats count_text(const char* begin, const char* end, unsigned, Heavy_Hitters& T)
+{
+    return count_words(begin, end, T);
+}
+
+Count_Stats count_text(const char* begin, const char* end, unsigned n_threads, Shared_Freq_Table& T)
+{
+    return count_words_shared(begin, end, n_threads, T);
+}
+
+
+//Display the statistics of the table T, filled with the words counted in stats
+template <typename Probing>
+void display_stats(ostream& os, const Word_Table<Probing>& T, const Count_Stats& stats)
+{
+    unsigned long _count = stats.words;
+    unsigned long total = stats.visited_slots;
+
+    os << "\nNumber of words in the file = " << _count << endl;
+
+    os << "Number unique  words in the file = "
+       << T.get_number_OF_items() << endl;
+
+    os << "\nTable's load factor = "
+       << fixed << setprecision(2) << T.loadFactor() << endl;
+
+    os << "Number of Items created = "
+       << T.get_count_new_items() << endl;
+
+    os << "Number of memory allocations for Items and keys = "
+       << T.get_count_allocations() << endl;
+
+    os << "Memory used by the table = "
+       << T.memory_usage() << " bytes" << endl << endl;
+
+    os << "\nNumber of slots visited = "
+       << total << endl;
+
+    os << "Average Number of slots visited = "
+       << fixed << setprecision(2) << (double)total / _count << endl;
+}
+
+
+//Display the statistics of the approximate table T, filled with the words counted in stats
+//Same lines as for a Freq_Table, where the sketch's counters play the role of the slots
+void display_stats(ostream& os, const Heavy_Hitters& T, const Count_Stats& stats)
+{
+    unsigned long _count = stats.words;
+    unsigned long total = stats.visited_slots;
+    const Count_Min_Sketch& S = T.get_sketch();
+
+    os << "\nNumber of words in the file = " << _count << endl;
+
+    os << "Number unique  words in the file (estimate) = "
+       << fixed << setprecision(0) << T.distinct_estimate() << endl;
+
+    os << "Number of words monitored = "
+       << T.get_number_OF_items() << endl;
+
+    os << "\nSketch's size = "
+       << S.get_depth() << " x " << S.get_width() << " counters" << endl;
+
+    os << "Memory used by the sketch and the monitored words = "
+       << T.memory_usage() << " bytes" << endl;
+
+    os << "Maximum error of a count = "
+       << fixed << setprecision(2) << (double) _count * S.get_error() << endl << endl;
+
+    os << "\nNumber of counters visited = "
+       << total << endl;
+
+    os << "Average Number of counters visited = "
+       << fixed << setprecision(2) << (double)total / _count << endl;
+}
+
+
+//Display the occupancy of T and, if compiled with TABLE_STATS, its probe statistics
+template <typename Probing>
+void display_instrumentation(ostream& os, const Word_Table<Probing>& T)
+{
+    os << "\nTable's occupancy ...\n" << T.analyze();
+
+#ifdef TABLE_STATS
+    os << "\nProbe statistics ...\n" << T.get_stats();
+#endif
 }
 
 
-//Hash function for English words
-//Polynomial accumulation
-//the Horner's rule is used to compute the value
-//See pag. 213 of course book
-unsigned _hash(string s, int tableSize)
+//Display the k most frequent words in T
+template <typename Table>
+void display_top_k(ostream& os, const Table& T, unsigned k)
 {
-    unsigned hashVal = 0;
+    Top_K<string_view, unsigned long> top(k);
+
+    T.for_each([&top](string_view key, unsigned long v)
+    {
+        top.add(key, v);
+    });
+
+    display_top(os, top.sorted());
+}
+
 
-    for(unsigned i = 0; i < s.length(); i++)
-        hashVal = 37 * hashVal + s[i];
+//Write the frequency table T to out, as requested by report (see main)
+//All lines have the format of Item's operator<<
+template <typename Table>
+void write_report(Buffered_Writer& out, const Table& T, const string& report, unsigned k)
+{
+    if (report == "top")
+    {
+        Top_K<string_view, unsigned long> top(k);
 
-    hashVal %= tableSize;
+        T.for_each([&top](string_view key, unsigned long v)
+        {
+            top.add(key, v);
+        });
+
+        out << "Top " << k << " words ...\n\n";
+
+        for (const auto& e : top.sorted())
+            write_item(out, e.first, e.second);
+    }
+    else if (report == "sorted")
+    {
+        out << "Frequency table, sorted by frequency ...\n\n";
+
+        for (const auto& e : sorted_entries<string_view, unsigned long>(T))
+            write_item(out, e.first, e.second);
+    }
+    else
+    {
+        out << "Frequency table ...\n\n";
+
+        T.for_each([&out](string_view key, unsigned long v)
+        {
+            write_item(out, key, v);
+        });
+    }
 
-    return hashVal;
+    out << '\n';
 }
@@ -0,0 +1,225 @@
+/*
+  Course: TND004, Lab 2
+  Description: class Mapped_File gives read-only access to the contents of a file as an array of chars
+              Regular files are memory mapped (no copy), other files (e.g. pipes) are read in large blocks
+*/
+
+#ifndef MAPPEDFILE_H_INCLUDED
+#define MAPPEDFILE_H_INCLUDED
+
+#include <string>
+#include <cstdio>
+#include <cstddef>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX  //windows.h must not define macros min and max
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+class Mapped_File
+{
+public:
+
+    //Size of the blocks used to read files that cannot be mapped
+    static constexpr size_t READ_BLOCK = 1 << 20;
+
+    //Open the file name
+    //Use is_open() to test whether it succeeded
+    explicit Mapped_File(const string& name)
+    {
+        if (!map_file(name))
+            read_file(name);
+    }
+
+    ~Mapped_File()
+    {
+        unmap();
+    }
+
+    //Return true if the file could be opened
+    bool is_open() const
+    {
+        return opened;
+    }
+
+    //Return true if the file is memory mapped
+    bool is_mapped() const
+    {
+        return mapped;
+    }
+
+    //Return a pointer to the first char of the file
+    const char* begin() const
+    {
+        return mapped ? first : buffer.data();
+    }
+
+    //Return a pointer past the last char of the file
+    const char* end() const
+    {
+        return begin() + size();
+    }
+
+    //Return size of the file in bytes
+    size_t size() const
+    {
+        return mapped ? length : buffer.size();
+    }
+
+private:
+
+    const char* first = nullptr;  //mapped memory
+    size_t length = 0;            //size of the mapped memory
+    string buffer;                //contents of a file that is not mapped
+    bool opened = false;
+    bool mapped = false;
+
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    //Map the file name, return false if it is not a non-empty regular file
+    bool map_file(const string& name);
+
+    //Read the file name in blocks of READ_BLOCK bytes
+    void read_file(const string& name);
+
+    void unmap();
+
+    //Disable copy constructor!!
+    Mapped_File(const Mapped_File &) = delete;
+
+    //Disable assignment operator!!
+    const Mapped_File& operator=(const Mapped_File &) = delete;
+};
+
+
+/* ********************************** *
+* Member functions implementation     *
+* *********************************** */
+
+#if defined(_WIN32)
+
+inline bool Mapped_File::map_file(const string& name)
+{
+    file = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    LARGE_INTEGER sz;
+
+    if (file == INVALID_HANDLE_VALUE || GetFileType(file) != FILE_TYPE_DISK ||
+        !GetFileSizeEx(file, &sz) || sz.QuadPart == 0)
+    {
+        unmap();
+        return false;
+    }
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    first = mapping ? (const char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+    if (!first)
+    {
+        unmap();
+        return false;
+    }
+
+    length = (size_t) sz.QuadPart;
+    opened = mapped = true;
+
+    return true;
+}
+
+
+inline void Mapped_File::unmap()
+{
+    if (first)
+        UnmapViewOfFile(first);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+
+    first = nullptr;
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+    mapped = false;
+}
+
+#else
+
+inline bool Mapped_File::map_file(const string& name)
+{
+    int fd = open(name.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  //the mapping stays valid
+
+    if (p == MAP_FAILED)
+        return false;
+
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+    first = (const char*) p;
+    length = st.st_size;
+    opened = mapped = true;
+
+    return true;
+}
+
+
+inline void Mapped_File::unmap()
+{
+    if (first)
+        munmap((void*) first, length);
+
+    first = nullptr;
+    mapped = false;
+}
+
+#endif
+
+
+inline void Mapped_File::read_file(const string& name)
+{
+    FILE* f = fopen(name.c_str(), "rb");
+
+    if (!f)
+        return;
+
+    size_t n = 0;
+
+    do
+    {
+        buffer.resize(n + READ_BLOCK);
+        n += fread(&buffer[n], 1, READ_BLOCK, f);
+    }
+    while (n == buffer.size());
+
+    buffer.resize(n);
+    opened = !ferror(f);
+    fclose(f);
+}
+
+#endif // MAPPEDFILE_H_INCLUDED
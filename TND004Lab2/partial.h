@@ -0,0 +1,353 @@
+/*
+  Course: TND004, Lab 2
+  Description: partial count files, used by the driver in main.cpp (options -w and -m)
+              A partial file holds the word frequencies counted by one run, e.g. over a shard of the input
+              Any number of partial files are combined by a k-way merge, reading each file once
+*/
+
+#ifndef PARTIAL_H_INCLUDED
+#define PARTIAL_H_INCLUDED
+
+#include "hashTable.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+using namespace std;
+
+
+/* ********************************** *
+* Partial file format                 *
+* *********************************** */
+
+//A partial file is a Partial_Header followed by n_items records, sorted by increasing key (as by memcmp)
+//   uint32_t     key_length
+//   Value_Type   value
+//   char         key[key_length]
+//Since the keys are sorted, partial files are merged in a single pass with memory for one record per file
+//Numbers are stored in the byte order of the machine that wrote the file
+
+const char PARTIAL_MAGIC[8] = { 'T', 'N', 'D', 'P', 'A', 'R', 'T', '1' };
+
+//Size of the stdio buffer of each partial file read or written
+const size_t PARTIAL_BUFFER = 1 << 16;
+
+struct Partial_Header
+{
+    char magic[8];        //PARTIAL_MAGIC
+    uint32_t value_size;  //sizeof(Value_Type)
+    uint32_t unused;
+    uint64_t n_items;     //number of records
+    uint64_t total;       //sum of the values, i.e. the number of words counted
+};
+
+
+/* ********************************** *
+* Class Partial_Writer                *
+* *********************************** */
+
+//Template class to write a partial file, record by record
+//The records must be added by increasing key
+template <typename Value_Type>
+class Partial_Writer
+{
+public:
+
+    static_assert(is_trivially_copyable<Value_Type>::value, "partial values are written as bytes");
+
+    //Create the partial file name
+    //Use is_open() to test whether it succeeded
+    explicit Partial_Writer(const string& name)
+        : file(fopen(name.c_str(), "wb"))
+    {
+        if (!file)
+            return;
+
+        setvbuf(file, nullptr, _IOFBF, PARTIAL_BUFFER);
+
+        memcpy(header.magic, PARTIAL_MAGIC, sizeof(header.magic));
+        header.value_size = sizeof(Value_Type);
+
+        //re-written by close() with the number of records
+        ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+
+    ~Partial_Writer()
+    {
+        close();
+    }
+
+    bool is_open() const
+    {
+        return file != nullptr;
+    }
+
+    //Add the record (key, v)
+    void add(string_view key, const Value_Type& v)
+    {
+        uint32_t length = key.size();
+
+        ok = ok && fwrite(&length, sizeof(length), 1, file) == 1 &&
+             fwrite(&v, sizeof(v), 1, file) == 1 &&
+             fwrite(key.data(), 1, length, file) == length;
+
+        ++header.n_items;
+        header.total += v;
+    }
+
+    //Write the header and close the file
+    //Return false if the file could not be written
+    bool close()
+    {
+        if (!file)
+            return ok;
+
+        ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = (fclose(file) == 0) && ok;
+        file = nullptr;
+
+        return ok;
+    }
+
+private:
+
+    FILE* file;
+    Partial_Header header = { };
+    bool ok = false;
+
+    //Disable copy constructor!!
+    Partial_Writer(const Partial_Writer &) = delete;
+
+    //Disable assignment operator!!
+    const Partial_Writer& operator=(const Partial_Writer &) = delete;
+};
+
+
+//Write the items of table T to the partial file name
+//Return false if the file could not be written
+template <typename Value_Type, typename Hasher, typename Key_Equal, typename... Policies>
+bool save_partial(const HashTable<string, Value_Type, Hasher, Key_Equal, Policies...>& T, const string& name)
+{
+    vector<pair<string_view, Value_Type> > items;
+
+    items.reserve(T.get_number_OF_items());
+
+    T.for_each([&items](string_view key, const Value_Type& v)
+    {
+        items.emplace_back(key, v);
+    });
+
+    sort(items.begin(), items.end(),
+         [](const pair<string_view, Value_Type>& a, const pair<string_view, Value_Type>& b)
+         {
+             return a.first < b.first;
+         });
+
+    Partial_Writer<Value_Type> out(name);
+
+    if (!out.is_open())
+        return false;
+
+    for (const auto& e : items)
+        out.add(e.first, e.second);
+
+    return out.close();
+}
+
+
+/* ********************************** *
+* Class Partial_Reader                *
+* *********************************** */
+
+//Template class to read a partial file, record by record
+template <typename Value_Type>
+class Partial_Reader
+{
+public:
+
+    static_assert(is_trivially_copyable<Value_Type>::value, "partial values are read as bytes");
+
+    //Open the partial file name
+    //Use is_open() to test whether it succeeded, i.e. the file is a valid partial file
+    explicit Partial_Reader(const string& name)
+        : file(fopen(name.c_str(), "rb"))
+    {
+        if (!file)
+            return;
+
+        setvbuf(file, nullptr, _IOFBF, PARTIAL_BUFFER);
+
+        if (fread(&header, sizeof(header), 1, file) != 1 ||
+            memcmp(header.magic, PARTIAL_MAGIC, sizeof(header.magic)) != 0 ||
+            header.value_size != sizeof(Value_Type))
+        {
+            fclose(file);
+            file = nullptr;
+        }
+    }
+
+    ~Partial_Reader()
+    {
+        if (file)
+            fclose(file);
+    }
+
+    bool is_open() const
+    {
+        return file != nullptr;
+    }
+
+    //Return true if the file was truncated or its keys are not sorted
+    bool corrupted() const
+    {
+        return bad;
+    }
+
+    uint64_t get_number_OF_items() const
+    {
+        return header.n_items;
+    }
+
+    uint64_t get_total() const
+    {
+        return header.total;
+    }
+
+    //Read the next record, return false after the last one
+    bool next();
+
+    //Current record
+    string_view key() const
+    {
+        return _key;
+    }
+
+    const Value_Type& value() const
+    {
+        return _value;
+    }
+
+private:
+
+    FILE* file;
+    Partial_Header header = { };
+    uint64_t n_read = 0;  //records read
+    bool bad = false;
+
+    string _key;
+    Value_Type _value;
+
+    //Disable copy constructor!!
+    Partial_Reader(const Partial_Reader &) = delete;
+
+    //Disable assignment operator!!
+    const Partial_Reader& operator=(const Partial_Reader &) = delete;
+};
+
+
+template <typename Value_Type>
+bool Partial_Reader<Value_Type>::next()
+{
+    if (!file || bad || n_read == header.n_items)
+        return false;
+
+    uint32_t length;
+    string previous;
+
+    swap(previous, _key);
+
+    if (fread(&length, sizeof(length), 1, file) != 1 || fread(&_value, sizeof(_value), 1, file) != 1)
+    {
+        bad = true;
+        return false;
+    }
+
+    _key.resize(length);
+
+    if (fread(&_key[0], 1, length, file) != length || (n_read > 0 && !(previous < _key)))
+    {
+        bad = true;
+        return false;
+    }
+
+    ++n_read;
+    return true;
+}
+
+
+/* ********************************** *
+* K-way merge                         *
+* *********************************** */
+
+//Merge the partial files names: call f(key, value) for every key in any of the files, by increasing key,
+//where value is the sum of the key's values in the files
+//The files are read once, in parallel: a min-heap holds the current record of each file,
+//thus merging k files with n records in total takes O(n log k) time and O(k) memory
+//Return false if a file could not be opened or is corrupted
+template <typename Value_Type, typename Function>
+bool merge_partials(const vector<string>& names, Function f)
+{
+    typedef Partial_Reader<Value_Type> Reader;
+
+    vector<unique_ptr<Reader> > files;
+    vector<Reader*> heap;  //files with a current record, the smallest key is heap.front()
+
+    for (const string& name : names)
+    {
+        files.emplace_back(new Reader(name));
+
+        if (!files.back()->is_open())
+            return false;
+
+        if (files.back()->next())
+            heap.push_back(files.back().get());
+    }
+
+    auto greater_key = [](const Reader* a, const Reader* b)
+    {
+        return a->key() > b->key();
+    };
+
+    make_heap(heap.begin(), heap.end(), greater_key);
+
+    string key;
+
+    while (!heap.empty())
+    {
+        key = heap.front()->key();
+        Value_Type sum = Value_Type();
+
+        //add up the current records of all files with this key
+        while (!heap.empty() && heap.front()->key() == key)
+        {
+            Reader* r = heap.front();
+
+            pop_heap(heap.begin(), heap.end(), greater_key);
+            sum += r->value();
+
+            if (r->next())
+                push_heap(heap.begin(), heap.end(), greater_key);
+            else
+                heap.pop_back();
+        }
+
+        f(string_view(key), sum);
+    }
+
+    for (const auto& r : files)
+    {
+        if (r->corrupted())
+            return false;
+    }
+
+    return true;
+}
+
+#endif // PARTIAL_H_INCLUDED
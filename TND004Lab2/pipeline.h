@@ -0,0 +1,555 @@
+/*
+  Course: TND004, Lab 2
+  Description: pipelined word counting, used by the driver in main.cpp (option -P)
+              A reader, one or more tokenizers, and a counter run as separate stages connected by
+              bounded lock-free ring buffers, so that reading the input overlaps with counting
+*/
+
+#ifndef PIPELINE_H_INCLUDED
+#define PIPELINE_H_INCLUDED
+
+#include "wordCount.h"
+#include "tokenizer.h"
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <string_view>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+using namespace std;
+
+
+//Number of bytes read at a time by the reader stage
+const size_t PIPELINE_CHUNK = 256 * 1024;
+
+//Number of chunk buffers, the reader waits when all of them are in the pipeline
+const unsigned PIPELINE_CHUNKS = 8;
+
+//Number of token batches of each tokenizer, a tokenizer waits when all of them are in the pipeline
+const unsigned PIPELINE_BATCHES = 16;
+
+
+/* ********************************** *
+* Ring buffers                        *
+* *********************************** */
+
+//Return the smallest power of two >= n
+inline size_t ring_capacity(size_t n)
+{
+    size_t c = 1;
+
+    while (c < n)
+        c *= 2;
+
+    return c;
+}
+
+
+//Bounded lock-free queue with a single producer thread and a single consumer thread
+//The producer only writes tail and the consumer only writes head, in different cache lines
+template <typename T>
+class Spsc_Ring
+{
+public:
+
+    //Create a ring with room for at least capacity values
+    explicit Spsc_Ring(size_t capacity)
+        : mask(ring_capacity(capacity) - 1), slots(new T[mask + 1]) { }
+
+    //Add v at the end of the ring, return false if the ring is full
+    bool try_push(const T& v)
+    {
+        size_t t = tail.load(memory_order_relaxed);
+
+        if (t - head.load(memory_order_acquire) > mask)
+            return false;
+
+        slots[t & mask] = v;
+        tail.store(t + 1, memory_order_release);
+        return true;
+    }
+
+    //Remove the first value of the ring into v, return false if the ring is empty
+    bool try_pop(T& v)
+    {
+        size_t h = head.load(memory_order_relaxed);
+
+        if (h == tail.load(memory_order_acquire))
+            return false;
+
+        v = slots[h & mask];
+        head.store(h + 1, memory_order_release);
+        return true;
+    }
+
+private:
+
+    const size_t mask;
+    unique_ptr<T[]> slots;
+
+    alignas(64) atomic<size_t> head { 0 };  //next value to pop
+    alignas(64) atomic<size_t> tail { 0 };  //next free slot
+
+    //Disable copy constructor!!
+    Spsc_Ring(const Spsc_Ring &) = delete;
+
+    //Disable assignment operator!!
+    const Spsc_Ring& operator=(const Spsc_Ring &) = delete;
+};
+
+
+//Bounded lock-free queue with several producer threads and a single consumer thread
+//Each slot has a sequence number telling whether it is free or full for the current lap (Vyukov)
+template <typename T>
+class Mpsc_Ring
+{
+public:
+
+    //Create a ring with room for at least capacity values
+    explicit Mpsc_Ring(size_t capacity)
+        : mask(ring_capacity(capacity) - 1), cells(new Cell[mask + 1])
+    {
+        for (size_t i = 0; i <= mask; ++i)
+            cells[i].seq.store(i, memory_order_relaxed);
+    }
+
+    //Add v at the end of the ring, return false if the ring is full
+    bool try_push(const T& v)
+    {
+        size_t pos = tail.load(memory_order_relaxed);
+
+        for (;;)
+        {
+            Cell& c = cells[pos & mask];
+            intptr_t dif = (intptr_t) c.seq.load(memory_order_acquire) - (intptr_t) pos;
+
+            if (dif == 0)
+            {
+                //claim the slot, then fill it
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                {
+                    c.value = v;
+                    c.seq.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = tail.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    //Remove the first value of the ring into v, return false if the ring is empty
+    bool try_pop(T& v)
+    {
+        Cell& c = cells[head & mask];
+
+        if ((intptr_t) c.seq.load(memory_order_acquire) - (intptr_t) (head + 1) < 0)
+            return false;
+
+        v = c.value;
+        c.seq.store(head + mask + 1, memory_order_release);
+        ++head;
+        return true;
+    }
+
+private:
+
+    struct Cell
+    {
+        atomic<size_t> seq;
+        T value;
+    };
+
+    const size_t mask;
+    unique_ptr<Cell[]> cells;
+
+    alignas(64) atomic<size_t> tail { 0 };  //next slot claimed by a producer
+    alignas(64) size_t head = 0;            //next value to pop, only used by the consumer
+
+    //Disable copy constructor!!
+    Mpsc_Ring(const Mpsc_Ring &) = delete;
+
+    //Disable assignment operator!!
+    const Mpsc_Ring& operator=(const Mpsc_Ring &) = delete;
+};
+
+
+//Push v into ring R, waiting while R is full (backpressure)
+//waits is increased when the push had to wait
+template <typename Ring, typename T>
+void push_wait(Ring& R, const T& v, unsigned long& waits)
+{
+    if (R.try_push(v))
+        return;
+
+    ++waits;
+
+    while (!R.try_push(v))
+        this_thread::yield();
+}
+
+//Pop a value from ring R, waiting while R is empty
+//waits is increased when the pop had to wait
+template <typename Ring, typename T>
+void pop_wait(Ring& R, T& v, unsigned long& waits)
+{
+    if (R.try_pop(v))
+        return;
+
+    ++waits;
+
+    while (!R.try_pop(v))
+        this_thread::yield();
+}
+
+
+/* ********************************** *
+* Pipeline statistics                 *
+* *********************************** */
+
+//Throughput counters of a stage
+struct Stage_Stats
+{
+    unsigned long items = 0;        //chunks (reader) or token batches (tokenizers, counter) handled
+    unsigned long bytes = 0;        //bytes of text read or tokenized
+    unsigned long words = 0;        //words tokenized or counted
+    unsigned long full_waits = 0;   //times the stage waited for room downstream (backpressure)
+    unsigned long empty_waits = 0;  //times the stage waited for input
+    double seconds = 0;             //time from the start of the pipeline to the end of the stage
+
+    Stage_Stats& operator+=(const Stage_Stats& s)
+    {
+        items += s.items;
+        bytes += s.bytes;
+        words += s.words;
+        full_waits += s.full_waits;
+        empty_waits += s.empty_waits;
+        seconds = max(seconds, s.seconds);
+        return *this;
+    }
+};
+
+
+//Statistics of the stages, the tokenizers' counters are added together
+struct Pipeline_Stats
+{
+    unsigned n_tokenizers = 0;
+    Stage_Stats reader;
+    Stage_Stats tokenizers;
+    Stage_Stats counter;
+
+    Pipeline_Stats& operator+=(const Pipeline_Stats& s)
+    {
+        n_tokenizers = s.n_tokenizers;
+        reader += s.reader;
+        tokenizers += s.tokenizers;
+        counter += s.counter;
+        return *this;
+    }
+
+    friend ostream& operator<<(ostream& os, const Pipeline_Stats& S)
+    {
+        auto stage = [&os](const string& name, const Stage_Stats& s)
+        {
+            os << setw(14) << left << name << right
+               << setw(8) << s.items << " items"
+               << setw(10) << fixed << setprecision(1) << s.bytes / 1e6 << " MB"
+               << setw(12) << s.words << " words"
+               << setw(9) << setprecision(3) << s.seconds << " s";
+
+            if (s.seconds > 0)
+                os << setw(9) << setprecision(1) << s.bytes / 1e6 / s.seconds << " MB/s"
+                   << setw(12) << setprecision(0) << s.words / s.seconds << " words/s";
+
+            os << "   waits: input " << s.empty_waits << ", output " << s.full_waits << '\n';
+        };
+
+        stage("reader", S.reader);
+        stage("tokenizer x" + to_string(S.n_tokenizers), S.tokenizers);
+        stage("counter", S.counter);
+
+        return os;
+    }
+};
+
+
+/* ********************************** *
+* Pipelined counting                  *
+* *********************************** */
+
+//A chunk of text read by the reader stage, ending on a word boundary
+struct Text_Chunk
+{
+    vector<char> text;
+    size_t size = 0;  //bytes of text in use
+};
+
+//A batch of words of a chunk, made by a tokenizer stage
+//Words that need no normalization are views of the chunk, the others are copied into text
+struct Token_Batch
+{
+    string_view tokens[BLOCK];
+    unsigned n = 0;
+    vector<char> text;
+    Text_Chunk* release = nullptr;  //chunk to recycle after the batch is counted, if its last batch
+    unsigned owner = 0;             //tokenizer the batch belongs to
+};
+
+
+//Count the words read from stream f and add them to table
+//Stages, each one a thread but the counter:
+//   reader      reads chunks of PIPELINE_CHUNK bytes, cut on word boundaries as in count_stream
+//   tokenizers  n_tokenizers threads, chunks are dealt to them in turn; each one splits its chunks into batches of
+//               BLOCK words (see Tokenizer)
+//   counter     the calling thread, adds the batches to table with increment_many
+//Stages are connected by SPSC rings (reader to each tokenizer) and an MPSC ring (tokenizers to counter),
+//chunks and batches are recycled through SPSC rings back to their producer, thus the memory is bounded
+//and a stage waits when the next one is behind
+//Table is a Word_Table or any table with the member functions increment_many and get_total_visited_slots
+//After each chunk is counted, report(stats) is called by the calling thread with the statistics so far
+//The stage counters are added to ps
+template <typename Table, typename Function>
+Count_Stats count_pipelined(FILE* f, Table& table, unsigned n_tokenizers, Pipeline_Stats& ps, Function report)
+{
+    const unsigned T = max(1u, n_tokenizers);
+    const auto start = chrono::steady_clock::now();
+
+    auto elapsed = [&start]()
+    {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+
+    vector<Text_Chunk> chunks(PIPELINE_CHUNKS);
+    vector<Token_Batch> batches(T * PIPELINE_BATCHES);
+
+    Spsc_Ring<Text_Chunk*> free_chunks(PIPELINE_CHUNKS);  //counter to reader
+    vector<unique_ptr<Spsc_Ring<Text_Chunk*> > > to_tokenizer;  //reader to tokenizer i, nullptr ends the stream
+    vector<unique_ptr<Spsc_Ring<Token_Batch*> > > free_batches; //counter to tokenizer i
+    Mpsc_Ring<Token_Batch*> to_counter(T * (PIPELINE_BATCHES + 1));  //nullptr: a tokenizer ended
+
+    for (Text_Chunk& c : chunks)
+    {
+        c.text.resize(PIPELINE_CHUNK);
+        free_chunks.try_push(&c);
+    }
+
+    for (unsigned i = 0; i < T; ++i)
+    {
+        to_tokenizer.emplace_back(new Spsc_Ring<Text_Chunk*>(PIPELINE_CHUNKS));
+        free_batches.emplace_back(new Spsc_Ring<Token_Batch*>(PIPELINE_BATCHES));
+
+        for (unsigned j = 0; j < PIPELINE_BATCHES; ++j)
+        {
+            Token_Batch* b = &batches[i * PIPELINE_BATCHES + j];
+
+            b->owner = i;
+            free_batches[i]->try_push(b);
+        }
+    }
+
+    Stage_Stats reader_stats;
+    vector<Stage_Stats> tokenizer_stats(T);
+    Stage_Stats counter_stats;
+
+    //Reader stage
+    thread reader([&]()
+    {
+        Stage_Stats& st = reader_stats;
+        Text_Chunk* c;
+        size_t filled = 0;  //bytes in c
+        bool eof = false;
+        unsigned next_tokenizer = 0;
+
+        pop_wait(free_chunks, c, st.empty_waits);
+
+        while (!eof)
+        {
+            //a single word fills the chunk
+            if (filled == c->text.size())
+                c->text.resize(2 * c->text.size());
+
+            size_t n = fread(&c->text[filled], 1, c->text.size() - filled, f);
+
+            eof = (filled + n < c->text.size());
+            filled += n;
+            st.bytes += n;
+
+            const char* begin = c->text.data();
+            const char* end = begin + filled;
+            const char* cut = end;
+
+            //the last word may continue in the next chunk
+            if (!eof)
+            {
+                while (cut != begin && !(CHAR_CLASS[cut[-1]] & CC_SPACE))
+                    --cut;
+            }
+
+            if (cut == begin && !eof)
+                continue;
+
+            //the cut word is copied to the next chunk before c is sent
+            Text_Chunk* next = nullptr;
+
+            if (!eof)
+            {
+                pop_wait(free_chunks, next, st.empty_waits);
+
+                if (next->text.size() < size_t(end - cut))
+                    next->text.resize(c->text.size());
+
+                copy(cut, end, next->text.begin());
+            }
+
+            c->size = cut - begin;
+            ++st.items;
+            push_wait(*to_tokenizer[next_tokenizer], c, st.full_waits);
+            next_tokenizer = (next_tokenizer + 1) % T;
+
+            c = next;
+            filled = end - cut;
+        }
+
+        for (unsigned i = 0; i < T; ++i)
+            push_wait(*to_tokenizer[i], (Text_Chunk*) nullptr, st.full_waits);
+
+        st.seconds = elapsed();
+    });
+
+    //Tokenizer stages
+    vector<thread> tokenizers;
+
+    for (unsigned i = 0; i < T; ++i)
+    {
+        tokenizers.emplace_back([&, i]()
+        {
+            Stage_Stats& st = tokenizer_stats[i];
+            Text_Chunk* c;
+
+            for (;;)
+            {
+                pop_wait(*to_tokenizer[i], c, st.empty_waits);
+
+                if (!c)
+                    break;
+
+                const char* begin = c->text.data();
+                const char* end = begin + c->size;
+                Tokenizer words(begin, end);
+                Token_Batch* b;
+
+                st.bytes += c->size;
+
+                do
+                {
+                    pop_wait(*free_batches[i], b, st.empty_waits);
+
+                    b->n = words.next_block(b->tokens, BLOCK);
+                    b->release = (b->n == 0) ? c : nullptr;
+
+                    //normalized words are in the tokenizer's scratch buffer, valid until the next call
+                    size_t length = 0;
+
+                    for (unsigned k = 0; k < b->n; ++k)
+                    {
+                        if (b->tokens[k].data() < begin || b->tokens[k].data() >= end)
+                            length += b->tokens[k].size();
+                    }
+
+                    if (b->text.size() < length)
+                        b->text.resize(length);
+
+                    char* p = b->text.data();
+
+                    for (unsigned k = 0; k < b->n; ++k)
+                    {
+                        if (b->tokens[k].data() < begin || b->tokens[k].data() >= end)
+                        {
+                            copy(b->tokens[k].begin(), b->tokens[k].end(), p);
+                            b->tokens[k] = string_view(p, b->tokens[k].size());
+                            p += b->tokens[k].size();
+                        }
+                    }
+
+                    ++st.items;
+                    st.words += b->n;
+                    push_wait(to_counter, b, st.full_waits);
+                }
+                while (b->n > 0);
+            }
+
+            push_wait(to_counter, (Token_Batch*) nullptr, st.full_waits);
+            st.seconds = elapsed();
+        });
+    }
+
+    //Counter stage
+    Count_Stats total;
+    const unsigned long visited_before = table.get_total_visited_slots();
+    unsigned ended = 0;
+
+    while (ended < T)
+    {
+        Token_Batch* b;
+
+        pop_wait(to_counter, b, counter_stats.empty_waits);
+
+        if (!b)
+        {
+            ++ended;
+            continue;
+        }
+
+        table.increment_many(b->tokens, b->n);
+        ++counter_stats.items;
+        counter_stats.words += b->n;
+        total.words += b->n;
+
+        if (b->release)
+        {
+            counter_stats.bytes += b->release->size;
+            push_wait(free_chunks, b->release, counter_stats.full_waits);
+
+            total.visited_slots = table.get_total_visited_slots() - visited_before;
+            report(total);
+        }
+
+        push_wait(*free_batches[b->owner], b, counter_stats.full_waits);
+    }
+
+    counter_stats.seconds = elapsed();
+
+    reader.join();
+
+    for (thread& t : tokenizers)
+        t.join();
+
+    total.visited_slots = table.get_total_visited_slots() - visited_before;
+
+    Pipeline_Stats S;
+
+    S.n_tokenizers = T;
+    S.reader = reader_stats;
+    S.counter = counter_stats;
+
+    for (const Stage_Stats& s : tokenizer_stats)
+        S.tokenizers += s;
+
+    ps += S;
+
+    return total;
+}
+
+#endif // PIPELINE_H_INCLUDED
@@ -0,0 +1,294 @@
+/*
+  Course: TND004, Lab 2
+  Description: collision resolution policies of class HashTable
+              Linear_Probing, Quadratic_Probing, Double_Hashing: open addressing probe sequences
+              Cuckoo_Hashing: bucketized cuckoo hashing, a key is in one of two buckets of BUCKET slots
+              Tables using these policies have a prime number of slots (see nextPrime)
+*/
+
+#ifndef PROBING_H_INCLUDED
+#define PROBING_H_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+using namespace std;
+
+
+//A policy has
+//   cuckoo     false for open addressing: a search stops at the first empty slot of the sequence
+//              true for cuckoo hashing: a search visits all slots of the sequence, empty or not,
+//              and the table moves keys between their two buckets to make room (see HashTable::make_room)
+//   MAX_LOAD   highest max load factor accepted by the policy (see HashTable::set_max_load_factor)
+//   MIN_SIZE   smallest table size
+//   Sequence   the slots visited when searching a key with hash value hv in a table of size slots:
+//              *s is the current slot, ++s moves to the next one, s.at_end() is true after the last one
+//   expected_displacement(a)  mean position of a key in its sequence, with a uniform hash function and
+//              load factor a, or a negative value if unknown
+
+
+//Slot of the hash value hv in a table of size slots
+//Uses the high bits of a multiplicative hash, since the low bits select the home slot
+inline unsigned second_hash(size_t hv, unsigned size)
+{
+    return (unsigned) ((((uint64_t) hv * 0x9e3779b97f4a7c15ull) >> 32) % size);
+}
+
+
+/* ********************************** *
+* Functions to find prime numbers     *
+* *********************************** */
+
+
+//Test if a number is prime
+inline bool isPrime( int n )
+{
+    if( n == 2 || n == 3 )
+        return true;
+
+    if( n == 1 || n % 2 == 0 )
+        return false;
+
+    for( int i = 3; i * i <= n; i += 2 )
+        if( n % i == 0 )
+            return false;
+
+    return true;
+}
+
+
+//Return a prime number at least as large as n
+inline int nextPrime( int n )
+{
+    if( n % 2 == 0 )
+        n++;
+
+    for(; !isPrime( n ); n += 2 );
+
+    return n;
+}
+
+
+/* ********************************** *
+* Linear probing                      *
+* *********************************** */
+
+//Slots home, home+1, home+2, ...
+struct Linear_Probing
+{
+    static constexpr bool cuckoo = false;
+    static constexpr double MAX_LOAD = 0.99;
+    static constexpr unsigned MIN_SIZE = 2;
+
+    class Sequence
+    {
+    public:
+
+        Sequence(size_t hv, unsigned size)
+            : index(hv % size), size(size) { }
+
+        unsigned operator*() const
+        {
+            return index;
+        }
+
+        void operator++()
+        {
+            if (++index == size)
+                index = 0;
+        }
+
+        bool at_end() const
+        {
+            return false;
+        }
+
+    private:
+
+        unsigned index;
+        unsigned size;
+    };
+
+    //Successful search visits (1 + 1/(1 - a)) / 2 slots (Knuth)
+    static double expected_displacement(double a)
+    {
+        return (1.0 / (1.0 - a) - 1.0) / 2;
+    }
+};
+
+
+/* ********************************** *
+* Quadratic probing                   *
+* *********************************** */
+
+//Slots home, home+1, home+4, home+9, ...
+//With a prime table size the first (size+1)/2 slots of the sequence are different,
+//thus an empty slot is always found if the table is less than half full
+struct Quadratic_Probing
+{
+    static constexpr bool cuckoo = false;
+    static constexpr double MAX_LOAD = 0.5;
+    static constexpr unsigned MIN_SIZE = 2;
+
+    class Sequence
+    {
+    public:
+
+        Sequence(size_t hv, unsigned size)
+            : index(hv % size), size(size) { }
+
+        unsigned operator*() const
+        {
+            return index;
+        }
+
+        //(i+1)^2 - i^2 = 2i + 1
+        void operator++()
+        {
+            index = (index + 2 * i + 1) % size;
+            ++i;
+        }
+
+        bool at_end() const
+        {
+            return false;
+        }
+
+    private:
+
+        unsigned index;
+        unsigned size;
+        unsigned long i = 0;
+    };
+
+    //About the same as uniform probing: (1/a) ln(1/(1 - a)) slots for a successful search
+    static double expected_displacement(double a)
+    {
+        return (a > 0) ? log(1.0 / (1.0 - a)) / a - 1.0 : 0.0;
+    }
+};
+
+
+/* ********************************** *
+* Double hashing                      *
+* *********************************** */
+
+//Slots home, home+step, home+2*step, ..., where step depends on the key
+//With a prime table size every step visits all slots
+struct Double_Hashing
+{
+    static constexpr bool cuckoo = false;
+    static constexpr double MAX_LOAD = 0.99;
+    static constexpr unsigned MIN_SIZE = 2;
+
+    class Sequence
+    {
+    public:
+
+        Sequence(size_t hv, unsigned size)
+            : index(hv % size), step(1 + second_hash(hv, size - 1)), size(size) { }
+
+        unsigned operator*() const
+        {
+            return index;
+        }
+
+        void operator++()
+        {
+            index += step;
+
+            if (index >= size)
+                index -= size;
+        }
+
+        bool at_end() const
+        {
+            return false;
+        }
+
+    private:
+
+        unsigned index;
+        unsigned step;  //1 <= step < size
+        unsigned size;
+    };
+
+    //Uniform probing: (1/a) ln(1/(1 - a)) slots for a successful search
+    static double expected_displacement(double a)
+    {
+        return (a > 0) ? log(1.0 / (1.0 - a)) / a - 1.0 : 0.0;
+    }
+};
+
+
+/* ********************************** *
+* Bucketized cuckoo hashing           *
+* *********************************** */
+
+//The table is split into buckets of BUCKET consecutive slots
+//A key is stored in one of its two buckets, thus a search visits at most 2*BUCKET slots
+//(two cache lines for BUCKET = 4 and 8-byte slots)
+//When both buckets are full, keys are moved to their other bucket to make room
+template <unsigned B = 4>
+struct Cuckoo_Hashing
+{
+    static constexpr bool cuckoo = true;
+    static constexpr double MAX_LOAD = 0.9;
+    static constexpr unsigned BUCKET = B;
+    static constexpr unsigned MIN_SIZE = 2 * B;
+
+    //Number of keys moved before the table gives up and grows
+    static constexpr unsigned MAX_KICKS = 500;
+
+    //Number of buckets in a table of size slots, the last size % BUCKET slots are not used
+    //A table has at least MIN_SIZE slots (see HashTable::rehash), the result is never 0
+    static unsigned n_buckets(unsigned size)
+    {
+        return max(1u, size / B);
+    }
+
+    //Bucket number which (0 or 1) of the hash value hv
+    static unsigned bucket(size_t hv, unsigned size, unsigned which)
+    {
+        return which ? second_hash(hv, n_buckets(size)) : hv % n_buckets(size);
+    }
+
+    //The slots of the first bucket, then the ones of the second bucket
+    class Sequence
+    {
+    public:
+
+        Sequence(size_t hv, unsigned size)
+            : first(bucket(hv, size, 0) * B), second(bucket(hv, size, 1) * B) { }
+
+        unsigned operator*() const
+        {
+            return (i < B) ? first + i : second + (i - B);
+        }
+
+        void operator++()
+        {
+            ++i;
+        }
+
+        bool at_end() const
+        {
+            return i == 2 * B;
+        }
+
+    private:
+
+        unsigned first;   //first slot of the first bucket
+        unsigned second;  //first slot of the second bucket
+        unsigned i = 0;
+    };
+
+    static double expected_displacement(double)
+    {
+        return -1;
+    }
+};
+
+#endif // PROBING_H_INCLUDED
@@ -0,0 +1,214 @@
+/*
+  Course: TND004, Lab 2
+  Description: reports of word frequencies
+              template class Top_K keeps the k most frequent keys using a bounded heap
+              class Buffered_Writer writes a report to a file through one large buffer
+*/
+
+#ifndef REPORT_H_INCLUDED
+#define REPORT_H_INCLUDED
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include <charconv>
+#include <type_traits>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+
+//Template class to select the k entries (key, value) with the highest values
+//among the entries added with add()
+//Entries are kept in a min-heap of size k, thus adding n entries takes O(n log k) time
+//Ties are broken by key, the smallest key ranks first
+template <typename Key, typename Value>
+class Top_K
+{
+public:
+
+    typedef pair<Key, Value> Entry;
+
+    explicit Top_K(unsigned k)
+        : k(k)
+    {
+        heap.reserve(k);
+    }
+
+    //Add the entry (key, v)
+    void add(const Key& key, const Value& v)
+    {
+        if (heap.size() < k)
+        {
+            heap.emplace_back(key, v);
+            push_heap(heap.begin(), heap.end(), better);
+        }
+        else if (k > 0 && better(Entry(key, v), heap.front()))
+        {
+            pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = Entry(key, v);
+            push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+
+    //Return true if add(key, v) would select the entry (key, v)
+    //Used to build a key only for the entries that are selected, key may be of another type than Key (e.g. string_view)
+    template <typename K>
+    bool selects(const K& key, const Value& v) const
+    {
+        if (heap.size() < k)
+            return true;
+
+        return k > 0 && (v > heap.front().second || (v == heap.front().second && key < heap.front().first));
+    }
+
+    //Return the selected entries, sorted by decreasing value
+    vector<Entry> sorted() const
+    {
+        vector<Entry> v(heap);
+
+        sort(v.begin(), v.end(), better);
+
+        return v;
+    }
+
+    //Return true if a ranks before b
+    static bool better(const Entry& a, const Entry& b)
+    {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    }
+
+private:
+
+    unsigned k;
+    vector<Entry> heap;  //the worst selected entry is heap.front()
+};
+
+
+//Return all entries (key, value) of table T sorted by decreasing value, ties by key
+//T is any table with a member function for_each(f) calling f(key, value)
+template <typename Key, typename Value, typename Table>
+vector<pair<Key, Value> > sorted_entries(const Table& T)
+{
+    vector<pair<Key, Value> > v;
+
+    T.for_each([&v](const Key& key, const Value& value)
+    {
+        v.emplace_back(key, value);
+    });
+
+    sort(v.begin(), v.end(), Top_K<Key, Value>::better);
+
+    return v;
+}
+
+
+/* ********************************** *
+* Class Buffered_Writer               *
+* *********************************** */
+
+//Class to write text to a file through a buffer of BUFFER_SIZE bytes
+//The file is only written when the buffer is full, when flush() is called, or by the destructor
+class Buffered_Writer
+{
+public:
+
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    //f must be open for writing, it is not closed by the writer
+    explicit Buffered_Writer(FILE* f)
+        : file(f), buffer(new char[BUFFER_SIZE]) { }
+
+    ~Buffered_Writer()
+    {
+        flush();
+        delete[] buffer;
+    }
+
+    Buffered_Writer& operator<<(string_view s)
+    {
+        if (s.size() > BUFFER_SIZE - used)
+        {
+            flush();
+
+            if (s.size() > BUFFER_SIZE)
+            {
+                fwrite(s.data(), 1, s.size(), file);
+                return *this;
+            }
+        }
+
+        memcpy(buffer + used, s.data(), s.size());
+        used += s.size();
+
+        return *this;
+    }
+
+    Buffered_Writer& operator<<(char c)
+    {
+        if (used == BUFFER_SIZE)
+            flush();
+
+        buffer[used++] = c;
+
+        return *this;
+    }
+
+    //Write an integer in decimal
+    template <typename T>
+    typename enable_if<is_integral<T>::value, Buffered_Writer&>::type operator<<(T v)
+    {
+        const size_t MAX_DIGITS = 24;
+
+        if (BUFFER_SIZE - used < MAX_DIGITS)
+            flush();
+
+        used = to_chars(buffer + used, buffer + BUFFER_SIZE, v).ptr - buffer;
+
+        return *this;
+    }
+
+    //Write the contents of the buffer to the file
+    void flush()
+    {
+        fwrite(buffer, 1, used, file);
+        used = 0;
+    }
+
+private:
+
+    FILE* file;
+    char* buffer;
+    size_t used = 0;
+
+    //Disable copy constructor!!
+    Buffered_Writer(const Buffered_Writer &) = delete;
+
+    //Disable assignment operator!!
+    const Buffered_Writer& operator=(const Buffered_Writer &) = delete;
+};
+
+
+//Write the entry (key, value) in the same format as Item's operator<<
+template <typename Key, typename Value>
+void write_item(Buffered_Writer& out, const Key& key, const Value& value)
+{
+    out << "key = \"" << key << "\"    value = " << value << '\n';
+}
+
+
+//Display the entries in v, one per line with its rank
+template <typename Key, typename Value>
+void display_top(ostream& os, const vector<pair<Key, Value> >& v)
+{
+    for (unsigned i = 0; i < v.size(); ++i)
+    {
+        os << setw(6) << i + 1 << ": " << v[i].first << "  " << v[i].second << '\n';
+    }
+}
+
+#endif // REPORT_H_INCLUDED
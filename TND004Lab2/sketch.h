@@ -0,0 +1,464 @@
+/*
+  Course: TND004, Lab 2
+  Description: approximate word frequencies in fixed memory
+              class Count_Min_Sketch estimates the frequency of any key
+              class Space_Saving keeps the most frequent keys (heavy hitters)
+              class Distinct_Counter estimates the number of distinct keys (HyperLogLog)
+              class Heavy_Hitters combines both, it can replace a Freq_Table when counting words
+*/
+
+#ifndef SKETCH_H_INCLUDED
+#define SKETCH_H_INCLUDED
+
+#include "hashers.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+
+/* ********************************** *
+* Class Count_Min_Sketch              *
+* *********************************** */
+
+//Count-Min sketch: depth rows of width counters
+//The estimate of a key's frequency is never too small and, with probability 1 - delta,
+//it is at most eps * N too large, where N is the total count added
+class Count_Min_Sketch
+{
+public:
+
+    //width = e / eps and depth = ln(1 / delta), rounded up
+    Count_Min_Sketch(double eps, double delta)
+        : width(max(1.0, ceil(exp(1.0) / eps))), depth(max(1.0, ceil(log(1.0 / delta)))),
+          counters(width * depth, 0) { }
+
+    //Add count to the key with hash value hv
+    //Return the new estimate of the key's frequency
+    //Conservative update: only the counters equal to the minimum are increased, which keeps
+    //the same guarantee with smaller over-estimates
+    //The counters saturate at UINT32_MAX instead of wrapping, thus on very long streams the estimate
+    //of a key counted about 4 billion times stays UINT32_MAX (Heavy_Hitters then reports its Space_Saving count)
+    uint32_t add(uint64_t hv, uint32_t count = 1)
+    {
+        uint32_t est = estimate(hv);
+
+        est = (count > UINT32_MAX - est) ? UINT32_MAX : est + count;
+
+        for (unsigned i = 0; i < depth; ++i)
+        {
+            uint32_t& c = counters[i * width + index(hv, i)];
+
+            c = max(c, est);
+        }
+
+        return est;
+    }
+
+    //Return the estimate of the frequency of the key with hash value hv
+    uint32_t estimate(uint64_t hv) const
+    {
+        uint32_t est = UINT32_MAX;
+
+        for (unsigned i = 0; i < depth; ++i)
+            est = min(est, counters[i * width + index(hv, i)]);
+
+        return est;
+    }
+
+    unsigned get_width() const
+    {
+        return width;
+    }
+
+    unsigned get_depth() const
+    {
+        return depth;
+    }
+
+    //Return the error bound of the estimates, as a fraction of the total count
+    double get_error() const
+    {
+        return exp(1.0) / width;
+    }
+
+    //Return number of bytes used by the counters
+    size_t memory_usage() const
+    {
+        return counters.size() * sizeof(uint32_t);
+    }
+
+private:
+
+    const unsigned width;
+    const unsigned depth;
+    vector<uint32_t> counters;  //row i is counters[i*width, (i+1)*width)
+
+    //Column of row i for the hash value hv
+    //The rows use the hash functions h1 + i*h2 (double hashing)
+    unsigned index(uint64_t hv, unsigned i) const
+    {
+        uint32_t h1 = (uint32_t) hv;
+        uint32_t h2 = (uint32_t) (hv >> 32) | 1;
+
+        return (h1 + i * h2) % width;
+    }
+};
+
+
+/* ********************************** *
+* Class Distinct_Counter              *
+* *********************************** */
+
+//HyperLogLog estimate of the number of distinct keys, with 2^BITS registers of one byte
+//The standard error is about 1.04 / sqrt(2^BITS), i.e. 1.6%
+class Distinct_Counter
+{
+public:
+
+    static constexpr unsigned BITS = 12;
+    static constexpr unsigned REGISTERS = 1u << BITS;
+
+    Distinct_Counter()
+        : registers(REGISTERS, 0) { }
+
+    //Add the key with hash value hv
+    void add(uint64_t hv)
+    {
+        unsigned r = hv >> (64 - BITS);
+        uint64_t rest = (hv << BITS) | (1ull << (BITS - 1));  //the guard bit limits the rank
+        unsigned char rank = 1;
+
+        for (; !(rest >> 63); rest <<= 1)
+            ++rank;
+
+        registers[r] = max(registers[r], rank);
+    }
+
+    //Return the estimate of the number of distinct keys added
+    double estimate() const
+    {
+        const double m = REGISTERS;
+        double sum = 0;
+        unsigned zeros = 0;
+
+        for (unsigned char x : registers)
+        {
+            sum += ldexp(1.0, -x);
+            zeros += (x == 0);
+        }
+
+        double E = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+
+        //small range correction: linear counting
+        if (E <= 2.5 * m && zeros > 0)
+            return m * log(m / zeros);
+
+        return E;
+    }
+
+    //Return number of bytes used by the registers
+    size_t memory_usage() const
+    {
+        return registers.size();
+    }
+
+private:
+
+    vector<unsigned char> registers;
+};
+
+
+/* ********************************** *
+* Class Space_Saving                  *
+* *********************************** */
+
+//Space-Saving algorithm: m counters monitor the most frequent keys
+//When a key that is not monitored arrives and all counters are in use, it replaces the key with
+//the smallest count c, and it gets count c + 1 with error c
+//The count of a monitored key is never too small and at most N / m too large
+class Space_Saving
+{
+public:
+
+    struct Entry
+    {
+        string key;
+        uint64_t hv;
+        unsigned long count;
+        unsigned long error;  //count - error is a lower bound of the key's frequency
+    };
+
+    explicit Space_Saving(unsigned m)
+        : m(max(1u, m)), slots(2 * this->m, EMPTY)
+    {
+        entries.reserve(this->m);
+        heap.reserve(this->m);
+        heap_pos.reserve(this->m);
+    }
+
+    //Add one occurrence of key with hash value hv
+    void add(string_view key, uint64_t hv);
+
+    //Return the entry monitoring key, or nullptr if key is not monitored
+    const Entry* find(string_view key, uint64_t hv) const
+    {
+        int s = find_slot(key, hv);
+
+        return (slots[s] == EMPTY) ? nullptr : &entries[slots[s]];
+    }
+
+    //Return the monitored entries
+    const vector<Entry>& get_entries() const
+    {
+        return entries;
+    }
+
+    //Return number of bytes used, without the characters of the keys
+    size_t memory_usage() const
+    {
+        return entries.capacity() * sizeof(Entry) + (heap.capacity() + heap_pos.capacity() + slots.size()) * sizeof(int);
+    }
+
+private:
+
+    static constexpr int EMPTY = -1;
+
+    const unsigned m;
+    vector<Entry> entries;
+    vector<int> heap;      //min-heap of entry indexes, by count
+    vector<int> heap_pos;  //heap_pos[e] is the position of entry e in heap
+
+    //Open addressing index from keys to entries, linear probing, load factor at most 0.5
+    vector<int> slots;
+
+    //Return the slot of key, or the empty slot where it should be inserted
+    int find_slot(string_view key, uint64_t hv) const
+    {
+        unsigned s = hv % slots.size();
+
+        while (slots[s] != EMPTY && (entries[slots[s]].hv != hv || entries[slots[s]].key != key))
+        {
+            if (++s == slots.size())
+                s = 0;
+        }
+
+        return s;
+    }
+
+    //Remove the entry in slot s from the index
+    //The following entries of the cluster are moved back (no deleted markers are needed)
+    void erase_slot(unsigned s);
+
+    //Restore the heap order from position i downwards, after the count of heap[i] increased
+    void sift_down(unsigned i);
+
+    //Restore the heap order from position i upwards, after a new entry was added at i
+    void sift_up(unsigned i);
+};
+
+
+inline void Space_Saving::add(string_view key, uint64_t hv)
+{
+    int s = find_slot(key, hv);
+
+    if (slots[s] != EMPTY)
+    {
+        int e = slots[s];
+
+        ++entries[e].count;
+        sift_down(heap_pos[e]);
+        return;
+    }
+
+    if (entries.size() < m)
+    {
+        int e = entries.size();
+
+        entries.push_back(Entry { string(key), hv, 1, 0 });
+        slots[s] = e;
+
+        heap.push_back(e);
+        heap_pos.push_back(heap.size() - 1);
+        sift_up(heap.size() - 1);
+        return;
+    }
+
+    //replace the entry with the smallest count
+    int e = heap[0];
+    Entry& victim = entries[e];
+
+    erase_slot(find_slot(victim.key, victim.hv));
+
+    victim.key.assign(key.data(), key.size());  //re-uses the string's memory when possible
+    victim.hv = hv;
+    victim.error = victim.count;
+    ++victim.count;
+
+    slots[find_slot(key, hv)] = e;
+    sift_down(0);
+}
+
+
+inline void Space_Saving::erase_slot(unsigned s)
+{
+    const unsigned n = slots.size();
+
+    slots[s] = EMPTY;
+
+    for (unsigned j = (s + 1) % n; slots[j] != EMPTY; j = (j + 1) % n)
+    {
+        unsigned home = entries[slots[j]].hv % n;
+
+        //move slots[j] to s if its home slot is not in the cyclic range (s, j]
+        if ((j > s && (home <= s || home > j)) || (j < s && home <= s && home > j))
+        {
+            slots[s] = slots[j];
+            slots[j] = EMPTY;
+            s = j;
+        }
+    }
+}
+
+
+inline void Space_Saving::sift_down(unsigned i)
+{
+    const unsigned n = heap.size();
+
+    for (;;)
+    {
+        unsigned smallest = i;
+        unsigned l = 2 * i + 1, r = 2 * i + 2;
+
+        if (l < n && entries[heap[l]].count < entries[heap[smallest]].count)
+            smallest = l;
+        if (r < n && entries[heap[r]].count < entries[heap[smallest]].count)
+            smallest = r;
+
+        if (smallest == i)
+            return;
+
+        swap(heap[i], heap[smallest]);
+        heap_pos[heap[i]] = i;
+        heap_pos[heap[smallest]] = smallest;
+        i = smallest;
+    }
+}
+
+
+inline void Space_Saving::sift_up(unsigned i)
+{
+    while (i > 0)
+    {
+        unsigned parent = (i - 1) / 2;
+
+        if (entries[heap[parent]].count <= entries[heap[i]].count)
+            return;
+
+        swap(heap[i], heap[parent]);
+        heap_pos[heap[i]] = i;
+        heap_pos[heap[parent]] = parent;
+        i = parent;
+    }
+}
+
+
+/* ********************************** *
+* Class Heavy_Hitters                 *
+* *********************************** */
+
+//Approximate frequency table in fixed memory, for streams with an unbounded number of distinct words
+//Every word updates a Count_Min_Sketch, a Space_Saving summary with 1/eps counters and a Distinct_Counter,
+//thus the frequent words and their counts are known within eps * N, where N is the number of words
+//The reported count of a word is the smallest of the two (over-)estimates
+class Heavy_Hitters
+{
+public:
+
+    Heavy_Hitters(double eps, double delta)
+        : sketch(eps, delta), summary((unsigned) ceil(1.0 / eps)) { }
+
+    //Add one occurrence of each of the n keys
+    //Same interface as HashTable::increment_many, so that it can be used by count_words
+    void increment_many(const string_view keys[], unsigned n)
+    {
+        for (unsigned i = 0; i < n; ++i)
+        {
+            uint64_t hv = wy_hash_bytes(keys[i].data(), keys[i].size());
+
+            sketch.add(hv);
+            summary.add(keys[i], hv);
+            distinct.add(hv);
+        }
+
+        words += n;
+    }
+
+    //Return the estimate of the frequency of key
+    unsigned long estimate(string_view key) const
+    {
+        uint64_t hv = wy_hash_bytes(key.data(), key.size());
+        unsigned long est = sketch.estimate(hv);
+        const Space_Saving::Entry* e = summary.find(key, hv);
+
+        return e ? min(est, e->count) : est;
+    }
+
+    //Call f(key, count) for every monitored key
+    template <typename Function>
+    void for_each(Function f) const
+    {
+        for (const Space_Saving::Entry& e : summary.get_entries())
+            f(string_view(e.key), min(e.count, (unsigned long) sketch.estimate(e.hv)));
+    }
+
+    //Return number of words added
+    unsigned long get_number_OF_words() const
+    {
+        return words;
+    }
+
+    //Return number of monitored keys
+    unsigned get_number_OF_items() const
+    {
+        return summary.get_entries().size();
+    }
+
+    //Return an estimate of the number of distinct words
+    double distinct_estimate() const
+    {
+        return distinct.estimate();
+    }
+
+    //Return the total number of counters visited, depth per word
+    //Used by count_words as HashTable::get_total_visited_slots
+    unsigned long get_total_visited_slots() const
+    {
+        return words * sketch.get_depth();
+    }
+
+    const Count_Min_Sketch& get_sketch() const
+    {
+        return sketch;
+    }
+
+    //Return number of bytes used, without the characters of the monitored keys
+    size_t memory_usage() const
+    {
+        return sketch.memory_usage() + summary.memory_usage() + distinct.memory_usage();
+    }
+
+private:
+
+    Count_Min_Sketch sketch;
+    Space_Saving summary;
+    Distinct_Counter distinct;
+    unsigned long words = 0;
+};
+
+#endif // SKETCH_H_INCLUDED
@@ -0,0 +1,275 @@
+/*
+  Course: TND004, Lab 2
+  Description: binary snapshots of a HashTable with string keys
+              save_snapshot writes a table to a file
+              template class Snapshot_Table maps a snapshot file in memory as a read-only table,
+              which can be searched without rebuilding the table or re-hashing the keys
+*/
+
+#ifndef SNAPSHOT_H_INCLUDED
+#define SNAPSHOT_H_INCLUDED
+
+#include "hashTable.h"
+#include "hashers.h"
+#include "mappedFile.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+using namespace std;
+
+
+/* ********************************** *
+* Snapshot file format                *
+* *********************************** */
+
+//A snapshot file is made of the following sections, each starting at a multiple of 8 bytes
+//   Snapshot_Header
+//   slots    uint32_t[n_slots]           index + 1 of the entry stored in the slot, 0 if the slot is empty
+//   entries  Snapshot_Entry[n_items]     hash value and position of the key of each entry
+//   values   Value_Type[n_items]
+//   keys     char[keys_size]             the characters of all keys, one after the other
+//The slots form an open addressing table with linear probing, where the home slot of
+//a key with hash value hv is hv % n_slots, and the load factor is at most MAX_LOAD_FACTOR
+//The hash values are the ones cached in the table's Items, thus keys are not re-hashed when saving
+//Numbers are stored in the byte order of the machine that wrote the snapshot
+
+const char SNAPSHOT_MAGIC[8] = { 'T', 'N', 'D', 'S', 'N', 'A', 'P', '1' };
+
+//Key hashed to check that a snapshot is read with the hash function it was written with
+const char SNAPSHOT_HASH_CHECK[] = "TND004 snapshot";
+
+struct Snapshot_Header
+{
+    char magic[8];          //SNAPSHOT_MAGIC
+    uint64_t hash_check;    //hash value of SNAPSHOT_HASH_CHECK
+    uint32_t value_size;    //sizeof(Value_Type)
+    uint32_t n_items;       //number of entries
+    uint32_t n_slots;       //number of slots, a prime number
+    uint32_t unused;
+    uint64_t keys_size;     //number of chars in the keys section
+};
+
+struct Snapshot_Entry
+{
+    uint64_t hash_value;
+    uint64_t key_offset;  //position of the key in the keys section
+    uint32_t key_length;
+    uint32_t unused;
+};
+
+
+//Return n rounded up to a multiple of 8
+inline size_t snapshot_align(size_t n)
+{
+    return (n + 7) & ~(size_t) 7;
+}
+
+
+//Write a snapshot of table T to the file name
+//Value_Type must be trivially copyable, since values are written as bytes
+//Return false if the file could not be written
+template <typename Value_Type, typename Hasher, typename Key_Equal, typename... Policies>
+bool save_snapshot(const HashTable<string, Value_Type, Hasher, Key_Equal, Policies...>& T, const string& name)
+{
+    static_assert(is_trivially_copyable<Value_Type>::value, "snapshot values are written as bytes");
+
+    const unsigned n = T.get_number_OF_items();
+
+    Snapshot_Header header = { };
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.hash_check = T.hash_function()(string_view(SNAPSHOT_HASH_CHECK));
+    header.value_size = sizeof(Value_Type);
+    header.n_items = n;
+    header.n_slots = nextPrime((int) (n / MAX_LOAD_FACTOR) + 1);
+
+    vector<uint32_t> slots(header.n_slots, 0);
+    vector<Snapshot_Entry> entries;
+    vector<Value_Type> values;
+    string keys;
+
+    entries.reserve(n);
+    values.reserve(n);
+
+    T.for_each_hashed([&](string_view key, const Value_Type& v, size_t hv)
+    {
+        unsigned s = hv % header.n_slots;
+
+        while (slots[s])
+        {
+            if (++s == header.n_slots)
+                s = 0;
+        }
+
+        entries.push_back(Snapshot_Entry { hv, keys.size(), (uint32_t) key.size(), 0 });
+        values.push_back(v);
+        keys.append(key.data(), key.size());
+
+        slots[s] = entries.size();
+    });
+
+    header.keys_size = keys.size();
+
+    FILE* f = fopen(name.c_str(), "wb");
+
+    if (!f)
+        return false;
+
+    //write the section data of the given size, followed by padding up to a multiple of 8
+    auto write_section = [f](const void* data, size_t size)
+    {
+        const char padding[8] = { };
+
+        return (size == 0 || fwrite(data, 1, size, f) == size) &&
+               fwrite(padding, 1, snapshot_align(size) - size, f) == snapshot_align(size) - size;
+    };
+
+    bool ok = write_section(&header, sizeof(header)) &&
+              write_section(slots.data(), slots.size() * sizeof(uint32_t)) &&
+              write_section(entries.data(), entries.size() * sizeof(Snapshot_Entry)) &&
+              write_section(values.data(), values.size() * sizeof(Value_Type)) &&
+              write_section(keys.data(), keys.size());
+
+    return (fclose(f) == 0) && ok;
+}
+
+
+/* ********************************** *
+* Class Snapshot_Table                *
+* *********************************** */
+
+//Template class to search a snapshot written by save_snapshot
+//The file is memory mapped (see Mapped_File), thus opening a snapshot does not depend on
+//the number of keys and only the pages used by the searches are read from disk
+//Since the entries are not checked when the file is opened, every slot and key read by a search
+//is checked against the bounds of its section: a corrupted snapshot gives wrong answers, but it is never
+//read outside the file
+//Hasher must compute the same hash values as the one of the saved table
+template <typename Value_Type, typename Hasher = wy_hash>
+class Snapshot_Table
+{
+public:
+
+    static_assert(is_trivially_copyable<Value_Type>::value, "snapshot values are read as bytes");
+    static_assert(alignof(Value_Type) <= 8, "snapshot sections are aligned to 8 bytes");
+
+    //Open the snapshot file name
+    //Use is_open() to test whether it succeeded, i.e. the file is a valid snapshot
+    explicit Snapshot_Table(const string& name, const Hasher& f = Hasher());
+
+
+    //Return true if the snapshot could be opened
+    bool is_open() const
+    {
+        return header != nullptr;
+    }
+
+    //Return number of items stored in the snapshot
+    unsigned get_number_OF_items() const
+    {
+        return header ? header->n_items : 0;
+    }
+
+    //Return a pointer to the value associated with key
+    //If key does not exist in the snapshot then nullptr is returned
+    const Value_Type* _find(string_view key) const;
+
+    //Call f(key, value) for every item in the snapshot
+    template <typename Function>
+    void for_each(Function f) const
+    {
+        for (unsigned i = 0; i < get_number_OF_items(); ++i)
+            f(key_of(entries[i]), values[i]);
+    }
+
+private:
+
+    Mapped_File file;
+    const Hasher h;
+
+    //Sections of the file, nullptr if the file is not a valid snapshot
+    const Snapshot_Header* header = nullptr;
+    const uint32_t* slots = nullptr;
+    const Snapshot_Entry* entries = nullptr;
+    const Value_Type* values = nullptr;
+    const char* keys = nullptr;
+
+    //Return the key of entry e, or an empty key if e is not in the keys section (corrupted file)
+    string_view key_of(const Snapshot_Entry& e) const
+    {
+        if (e.key_offset > header->keys_size || e.key_length > header->keys_size - e.key_offset)
+            return string_view();
+
+        return string_view(keys + e.key_offset, e.key_length);
+    }
+
+    //Disable copy constructor!!
+    Snapshot_Table(const Snapshot_Table &) = delete;
+
+    //Disable assignment operator!!
+    const Snapshot_Table& operator=(const Snapshot_Table &) = delete;
+};
+
+
+template <typename Value_Type, typename Hasher>
+Snapshot_Table<Value_Type, Hasher>::Snapshot_Table(const string& name, const Hasher& f)
+    : file(name), h(f)
+{
+    const char* p = file.begin();
+    const Snapshot_Header* hd = (const Snapshot_Header*) p;
+
+    if (!file.is_open() || file.size() < sizeof(Snapshot_Header) ||
+        memcmp(hd->magic, SNAPSHOT_MAGIC, sizeof(hd->magic)) != 0 ||
+        hd->value_size != sizeof(Value_Type) || hd->n_slots <= hd->n_items ||
+        hd->hash_check != (uint64_t) h(string_view(SNAPSHOT_HASH_CHECK)))
+    {
+        return;
+    }
+
+    size_t slots_at = snapshot_align(sizeof(Snapshot_Header));
+    size_t entries_at = slots_at + snapshot_align(hd->n_slots * sizeof(uint32_t));
+    size_t values_at = entries_at + snapshot_align(hd->n_items * sizeof(Snapshot_Entry));
+    size_t keys_at = values_at + snapshot_align(hd->n_items * sizeof(Value_Type));
+
+    if (keys_at > file.size() || hd->keys_size > file.size() - keys_at)
+        return;  //truncated file
+
+    header = hd;
+    slots = (const uint32_t*) (p + slots_at);
+    entries = (const Snapshot_Entry*) (p + entries_at);
+    values = (const Value_Type*) (p + values_at);
+    keys = p + keys_at;
+}
+
+
+template <typename Value_Type, typename Hasher>
+const Value_Type* Snapshot_Table<Value_Type, Hasher>::_find(string_view key) const
+{
+    if (!header)
+        return nullptr;
+
+    const uint64_t hv = h(key);
+    const uint32_t n_slots = header->n_slots;
+    uint32_t s = hv % n_slots;
+
+    //a valid snapshot has an empty slot, n_slots probes end the search in a corrupted one
+    for (uint32_t i = 0; i < n_slots && slots[s]; ++i, s = (s + 1 == n_slots) ? 0 : s + 1)
+    {
+        if (slots[s] > header->n_items)
+            return nullptr;  //corrupted file
+
+        const Snapshot_Entry& e = entries[slots[s] - 1];
+
+        if (e.hash_value == hv && key_of(e) == key)
+            return &values[slots[s] - 1];
+    }
+
+    return nullptr;
+}
+
+#endif // SNAPSHOT_H_INCLUDED
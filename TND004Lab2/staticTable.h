@@ -0,0 +1,267 @@
+/*
+  Course: TND004, Lab 2
+  Description: template class Static_Table is an immutable dictionary built at compile time
+              from an array of literal items, e.g. a table of keywords
+              Keys are placed with a minimal perfect hash function (hash and displace, as Frozen_Table),
+              thus a search reads a single slot and the table needs no initialization at run time
+*/
+
+#ifndef STATICTABLE_H_INCLUDED
+#define STATICTABLE_H_INCLUDED
+
+#include "hashers.h"
+
+#include <string_view>
+#include <type_traits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+
+//An item (key, value) of a Static_Table
+template <typename Key_Type, typename Value_Type>
+struct Static_Item
+{
+    Key_Type key;
+    Value_Type value;
+};
+
+
+//Default hash function of a Static_Table: int_hash for integer keys, fnv_hash for strings
+//Both can be computed at compile time
+template <typename Key_Type>
+using Static_Hash = typename conditional<is_integral<Key_Type>::value, int_hash, fnv_hash>::type;
+
+
+//Template class to represent an immutable table of N items stored in N slots
+//Key_Type and Value_Type must be literal types, e.g. string_view and int, thus a table
+//declared constexpr is built by the compiler:
+//   constexpr auto keywords = make_static_table<string_view, int>({ { "if", 1 }, { "else", 2 } });
+//   static_assert(*keywords._find("else") == 2);
+//
+//The slots are chosen as in Frozen_Table: keys are split in buckets and each bucket has a pilot such that
+//   slot(key) = mix(pos_hash(key), pilot[bucket(key)]) % N
+//sends all keys to different slots. Building the table fails to compile, or throws logic_error at run time,
+//if a key is repeated (or, very unlikely, two keys have the same hash value)
+//A table built at run time uses about 24 bytes of stack per key while it is built
+template <typename Key_Type, typename Value_Type, size_t N, typename Hasher = Static_Hash<Key_Type> >
+class Static_Table
+{
+public:
+
+    typedef Static_Item<Key_Type, Value_Type> Item;
+
+    //Average number of keys per bucket
+    static constexpr unsigned BUCKET_SIZE = 4;
+    static constexpr unsigned N_BUCKETS = N / BUCKET_SIZE + 1;
+
+    //Pilots tried for a bucket before the table is built again with another seed
+    //Both limits bound the work of the compiler (see -fconstexpr-ops-limit)
+    //All slots are used, thus the last buckets placed, of one key, need about N pilots
+    static constexpr uint32_t MAX_PILOT = (N < (1u << 11)) ? (1u << 14) : 8 * N;
+
+    //Seeds tried before the build gives up
+    static constexpr unsigned MAX_SEEDS = 16;
+
+
+    //Build the table with the N items in array items
+    constexpr explicit Static_Table(const Item (&items)[N]);
+
+
+    //Return number of items stored in the table
+    constexpr unsigned get_number_OF_items() const
+    {
+        return N;
+    }
+
+    //Return a pointer to the value associated with key
+    //If key does not exist in the table then nullptr is returned
+    //K is Key_Type or, for string keys, any type converted to string_view (e.g. string, const char*)
+    template <typename K>
+    constexpr const Value_Type* _find(const K& key) const
+    {
+        const size_t hv = Hasher()(key);
+        const Slot& s = slots[slot(pos_hash(hv), pilots[bucket(hv)])];
+
+        return (N > 0 && s.hash_value == hv && s.item.key == key) ? &s.item.value : nullptr;
+    }
+
+    //Return true if key is in the table
+    template <typename K>
+    constexpr bool contains(const K& key) const
+    {
+        return _find(key) != nullptr;
+    }
+
+    //Call f(key, value) for every item in the table
+    template <typename Function>
+    constexpr void for_each(Function f) const
+    {
+        for (size_t i = 0; i < N; ++i)
+            f(slots[i].item.key, slots[i].item.value);
+    }
+
+private:
+
+    //Arrays have at least one element, also for an empty table
+    static constexpr size_t SIZE = (N > 0) ? N : 1;
+
+    struct Slot
+    {
+        size_t hash_value = 0;  //compared before the keys, to reject most absent keys quickly
+        Item item = { };
+    };
+
+    uint64_t seed = 0;
+    uint32_t pilots[N_BUCKETS] = { };
+    Slot slots[SIZE] = { };
+
+
+    constexpr unsigned bucket(size_t hv) const
+    {
+        return wy_mix(hv, seed ^ 0xa0761d6478bd642full) % N_BUCKETS;
+    }
+
+    constexpr uint64_t pos_hash(size_t hv) const
+    {
+        return wy_mix(hv, seed ^ 0xe7037ed1a0b428dbull);
+    }
+
+    //Unlike Frozen_Table the pilot is multiplied in, not xor-ed: tables are small and N is often a power of 2,
+    //where xor-ing a pilot only permutes the slots and cannot separate keys with the same low bits
+    constexpr unsigned slot(uint64_t pos_hash, uint32_t pilot) const
+    {
+        return wy_mix(pos_hash, pilot ^ 0x8ebc6af09c88c6e3ull) % SIZE;
+    }
+
+    //Search a pilot for every bucket, for the keys with the (distinct) hash values hv
+    //Return false if some bucket cannot be placed with this seed
+    //Otherwise, slot_of[j] is set to the slot of the key with hash value hv[j] and true is returned
+    constexpr bool place(const size_t (&hv)[SIZE], unsigned (&slot_of)[SIZE]);
+};
+
+
+/* ********************************** *
+* Member functions implementation     *
+* *********************************** */
+
+//Seeds are tried in turn until every bucket gets a pilot
+template <typename Key_Type, typename Value_Type, size_t N, typename Hasher>
+constexpr Static_Table<Key_Type, Value_Type, N, Hasher>::Static_Table(const Item (&items)[N])
+{
+    size_t hv[SIZE] = { };
+    unsigned slot_of[SIZE] = { };
+
+    for (size_t i = 0; i < N; ++i)
+        hv[i] = Hasher()(items[i].key);
+
+    while (N > 0 && !place(hv, slot_of))
+    {
+        if (++seed == MAX_SEEDS)
+            throw logic_error("Static_Table: no perfect hash function was found");
+    }
+
+    for (size_t i = 0; i < N; ++i)
+        slots[slot_of[i]] = Slot { hv[i], items[i] };
+}
+
+
+//Buckets are placed from the largest to the smallest, each one with the first pilot that works
+template <typename Key_Type, typename Value_Type, size_t N, typename Hasher>
+constexpr bool Static_Table<Key_Type, Value_Type, N, Hasher>::place(const size_t (&hv)[SIZE], unsigned (&slot_of)[SIZE])
+{
+    //group the keys by bucket (counting sort)
+    unsigned first[N_BUCKETS + 1] = { };  //keys of bucket b are order[first[b], first[b+1])
+    unsigned next[N_BUCKETS] = { };
+    unsigned order[SIZE] = { };
+
+    for (size_t j = 0; j < N; ++j)
+        ++first[bucket(hv[j]) + 1];
+
+    for (unsigned b = 0; b < N_BUCKETS; ++b)
+    {
+        first[b + 1] += first[b];
+        next[b] = first[b];
+    }
+
+    for (size_t j = 0; j < N; ++j)
+        order[next[bucket(hv[j])]++] = j;
+
+    //largest buckets first (insertion sort, there are few buckets)
+    unsigned by_size[N_BUCKETS] = { };
+
+    for (unsigned b = 0; b < N_BUCKETS; ++b)
+    {
+        unsigned i = b;
+
+        for (; i > 0 && first[by_size[i - 1] + 1] - first[by_size[i - 1]] < first[b + 1] - first[b]; --i)
+            by_size[i] = by_size[i - 1];
+
+        by_size[i] = b;
+    }
+
+    bool taken[SIZE] = { };
+    unsigned tried[SIZE] = { };  //slots of the keys of the current bucket, for the current pilot
+
+    for (unsigned k = 0; k < N_BUCKETS; ++k)
+    {
+        const unsigned b = by_size[k];
+        const unsigned size = first[b + 1] - first[b];
+
+        if (size == 0)
+            break;
+
+        uint32_t pilot = 0;
+        unsigned n_tried = 0;
+
+        for (; pilot < MAX_PILOT && n_tried < size; ++pilot)
+        {
+            for (n_tried = 0; n_tried < size; ++n_tried)
+            {
+                const size_t x = hv[order[first[b] + n_tried]];
+                unsigned s = slot(pos_hash(x), pilot);
+                bool ok = !taken[s];
+
+                for (unsigned i = 0; i < n_tried && ok; ++i)
+                {
+                    ok = (tried[i] != s);
+
+                    //keys with the same hash value are in the same slot for every pilot and seed
+                    if (!ok && hv[order[first[b] + i]] == x)
+                        throw logic_error("Static_Table: repeated key, or two keys with the same hash value");
+                }
+
+                if (!ok)
+                    break;
+
+                tried[n_tried] = s;
+            }
+        }
+
+        if (n_tried < size)
+            return false;
+
+        pilots[b] = pilot - 1;
+
+        for (unsigned i = 0; i < size; ++i)
+        {
+            taken[tried[i]] = true;
+            slot_of[order[first[b] + i]] = tried[i];
+        }
+    }
+
+    return true;
+}
+
+
+//Build a Static_Table with the items in array items, the number of items is deduced
+//   constexpr auto T = make_static_table<string_view, int>({ { "a", 1 }, { "b", 2 } });
+template <typename Key_Type, typename Value_Type, typename Hasher = Static_Hash<Key_Type>, size_t N>
+constexpr Static_Table<Key_Type, Value_Type, N, Hasher> make_static_table(const Static_Item<Key_Type, Value_Type> (&items)[N])
+{
+    return Static_Table<Key_Type, Value_Type, N, Hasher>(items);
+}
+
+#endif // STATICTABLE_H_INCLUDED
@@ -0,0 +1,205 @@
+/*
+  Course: TND004, Lab 2
+  Description: instrumentation of class HashTable
+              The Stats template argument of HashTable is a policy receiving an event for every probe
+              and re-hash: No_Stats (default) ignores them, Probe_Stats records them in histograms
+              Table_Shape describes the occupancy of a table at some moment (see HashTable::analyze)
+*/
+
+#ifndef TABLESTATS_H_INCLUDED
+#define TABLESTATS_H_INCLUDED
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+
+//Operations of a HashTable, as reported to the Stats policy
+//INSERT_OP includes operator[] and the increments, which insert missing keys
+enum Table_Operation { FIND_OP, INSERT_OP, REMOVE_OP, N_OPERATIONS };
+
+const char* const OPERATION_NAME[N_OPERATIONS] = { "find", "insert", "remove" };
+
+
+/* ********************************** *
+* Class Histogram                     *
+* *********************************** */
+
+//Histogram of non-negative integer values
+//Values 0 to BINS-2 have their own bin, larger values are counted in the last bin
+class Histogram
+{
+public:
+
+    static constexpr unsigned BINS = 33;
+
+    void add(unsigned long x)
+    {
+        ++bins[min(x, (unsigned long) BINS - 1)];
+        ++n;
+        sum += x;
+        largest = max(largest, x);
+    }
+
+    unsigned long count() const
+    {
+        return n;
+    }
+
+    unsigned long max_value() const
+    {
+        return largest;
+    }
+
+    double mean() const
+    {
+        return n ? (double) sum / n : 0.0;
+    }
+
+    //Return the smallest value v such that at least fraction p of the values are <= v
+    //Values in the last bin are reported as BINS-1
+    unsigned long percentile(double p) const
+    {
+        unsigned long acc = 0;
+
+        for (unsigned i = 0; i < BINS; ++i)
+        {
+            acc += bins[i];
+
+            if (acc >= p * n && acc > 0)
+                return i;
+        }
+
+        return 0;
+    }
+
+    //Display the summary and the non-empty bins
+    friend ostream& operator<<(ostream& os, const Histogram& H)
+    {
+        os << "count = " << H.n << "  mean = " << fixed << setprecision(2) << H.mean()
+           << "  p50 = " << H.percentile(0.5) << "  p99 = " << H.percentile(0.99)
+           << "  max = " << H.largest << '\n';
+
+        for (unsigned i = 0; i < BINS; ++i)
+        {
+            if (H.bins[i])
+                os << setw(8) << i << ((i == BINS - 1) ? "+" : " ") << setw(12) << H.bins[i] << '\n';
+        }
+
+        return os;
+    }
+
+private:
+
+    unsigned long bins[BINS] = { };
+    unsigned long n = 0;
+    unsigned long sum = 0;
+    unsigned long largest = 0;
+};
+
+
+/* ********************************** *
+* Stats policies                      *
+* *********************************** */
+
+//No instrumentation: the member functions are empty and calls to them are removed by the compiler
+//HashTable does not read the clock when enabled is false
+struct No_Stats
+{
+    static constexpr bool enabled = false;
+
+    void on_probe(Table_Operation, unsigned) { }
+
+    void on_rehash(unsigned, unsigned, double) { }
+};
+
+
+//Histograms of the probe lengths of each operation, and re-hash count and durations
+struct Probe_Stats
+{
+    static constexpr bool enabled = true;
+
+    Histogram probe_length[N_OPERATIONS];  //slots visited by each operation
+
+    unsigned rehash_count = 0;
+    double rehash_seconds = 0;      //total time spent re-hashing
+    double max_rehash_seconds = 0;  //longest re-hash
+
+    //An operation op visited length slots
+    void on_probe(Table_Operation op, unsigned length)
+    {
+        probe_length[op].add(length);
+    }
+
+    //The table was re-hashed from old_size to new_size slots in seconds
+    void on_rehash(unsigned, unsigned, double seconds)
+    {
+        ++rehash_count;
+        rehash_seconds += seconds;
+        max_rehash_seconds = max(max_rehash_seconds, seconds);
+    }
+
+    friend ostream& operator<<(ostream& os, const Probe_Stats& S)
+    {
+        for (unsigned op = 0; op < N_OPERATIONS; ++op)
+        {
+            if (S.probe_length[op].count())
+                os << "Probe length (" << OPERATION_NAME[op] << "): " << S.probe_length[op];
+        }
+
+        os << "Re-hashes = " << S.rehash_count
+           << "  total time = " << fixed << setprecision(6) << S.rehash_seconds << " s"
+           << "  longest = " << S.max_rehash_seconds << " s\n";
+
+        return os;
+    }
+};
+
+
+/* ********************************** *
+* Struct Table_Shape                  *
+* *********************************** */
+
+//Occupancy of a HashTable, computed by scanning all slots (see HashTable::analyze)
+struct Table_Shape
+{
+    unsigned size = 0;     //number of slots
+    unsigned items = 0;    //slots in use
+    unsigned deleted = 0;  //slots marked as deleted (tombstones)
+
+    Histogram clusters;      //lengths of the runs of non-empty slots (deleted slots included)
+    Histogram displacement;  //position of each item in its probe sequence, 0 for the home slot
+
+    //Hash quality
+    unsigned equal_hashes = 0;  //items whose full hash value equals the one of another item
+    double expected_displacement = 0;  //mean displacement expected with a uniform hash function, < 0 if unknown
+
+    double tombstone_ratio() const
+    {
+        return size ? (double) deleted / size : 0.0;
+    }
+
+    friend ostream& operator<<(ostream& os, const Table_Shape& S)
+    {
+        os << "Slots = " << S.size << "  items = " << S.items << "  deleted = " << S.deleted
+           << "  tombstone ratio = " << fixed << setprecision(4) << S.tombstone_ratio() << '\n';
+
+        os << "Cluster length: " << S.clusters;
+        os << "Displacement: " << S.displacement;
+
+        os << "Expected mean displacement (uniform hashing) = ";
+
+        if (S.expected_displacement < 0)
+            os << "n/a\n";
+        else
+            os << fixed << setprecision(2) << S.expected_displacement << '\n';
+
+        os << "Items with an equal full hash value = " << S.equal_hashes << '\n';
+
+        return os;
+    }
+};
+
+#endif // TABLESTATS_H_INCLUDED
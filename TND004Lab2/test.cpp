@@ -8,23 +8,47 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <thread>
+#include <unordered_map>
+#include <random>
 
 #include "hashTable.h"
+#include "intHashTable.h"
+#include "concurrentHashTable.h"
+#include "frozenTable.h"
+#include "staticTable.h"
+#include "hashers.h"
 
 using namespace std;
 
 
-unsigned my_hash(string s, int tableSize);
+//Weak hash function: sum of the characters
+//Makes it easy to create collisions when testing
+struct my_hash
+{
+    size_t operator()(const string& s) const;
+};
 
 int menu();
 
+//Display the result of a test, return ok
+bool check(const string& test, bool ok);
+
+//Tests of the other tables, each one compares the table with a reference
+void test_concurrent_table();
+void test_frozen_table();
+void test_static_table();
+void test_int_table();
+void test_table_filter();
+
 
 //Test the code
 int main()
 {
     const int TABLE_SIZE = 7;
 
-    HashTable<string,int> table(TABLE_SIZE, my_hash);
+    HashTable<string,int,my_hash> table(TABLE_SIZE);
 
     string key;
     const int* p_value = nullptr;
@@ -83,6 +107,26 @@ int main()
             go = false;
             break;
 
+        case 6:
+            test_concurrent_table();
+            break;
+
+        case 7:
+            test_frozen_table();
+            break;
+
+        case 8:
+            test_static_table();
+            break;
+
+        case 9:
+            test_int_table();
+            break;
+
+        case 10:
+            test_table_filter();
+            break;
+
         default:
             cout << "\nEnter correct option\n";
         }
@@ -92,15 +136,13 @@ int main()
 }
 
 
-unsigned my_hash(string s, int tableSize)
+size_t my_hash::operator()(const string& s) const
 {
     unsigned hashVal = 0;
 
     for(unsigned i = 0; i < s.length(); i++)
         hashVal += s[i];
 
-    hashVal %= tableSize;
-
     return hashVal;
 }
 
@@ -119,6 +161,11 @@ int menu()
     cout << "3. Delete" << endl;
     cout << "4. Dump table" << endl;
     cout << "5. Exit" << endl;
+    cout << "6. Test Concurrent_HashTable" << endl;
+    cout << "7. Test Frozen_Table" << endl;
+    cout << "8. Test Static_Table" << endl;
+    cout << "9. Test HashTable with int_hash" << endl;
+    cout << "10. Test HashTable with a Bloom filter" << endl;
 
     cout << "Enter your choice: ";
 
@@ -128,3 +175,299 @@ int menu()
 }
 
 
+//Display the result of a test, return ok
+bool check(const string& test, bool ok)
+{
+    cout << (ok ? "OK      " : "FAILED  ") << test << endl;
+
+    return ok;
+}
+
+
+//Several threads increment the same keys at the same time, no increment may be lost
+void test_concurrent_table()
+{
+    const unsigned N_THREADS = 8;
+    const unsigned N_KEYS = 1000;
+    const unsigned ROUNDS = 100;
+
+    Concurrent_HashTable<string, int> table(7, 4);
+    vector<string> keys;
+    vector<thread> workers;
+
+    for (unsigned i = 0; i < N_KEYS; ++i)
+        keys.push_back("key" + to_string(i));
+
+    for (unsigned t = 0; t < N_THREADS; ++t)
+    {
+        workers.emplace_back([&table, &keys, t]()
+        {
+            for (unsigned r = 0; r < ROUNDS; ++r)
+            {
+                //each thread visits the keys from a different position
+                for (unsigned i = 0; i < N_KEYS; ++i)
+                    table.increment(keys[(i + t * N_KEYS / N_THREADS) % N_KEYS]);
+            }
+        });
+    }
+
+    for (thread& w : workers)
+        w.join();
+
+    bool ok = true;
+    int v = 0;
+
+    for (const string& key : keys)
+        ok = ok && table._find(key, v) && v == (int) (N_THREADS * ROUNDS);
+
+    check("increments by " + to_string(N_THREADS) + " threads", ok);
+    check("number of items", table.get_number_OF_items() == N_KEYS);
+    check("absent key", !table._find(string("absent"), v));
+
+    table.increment_many(&keys[0], N_KEYS);
+    check("increment_many", table._find(keys[N_KEYS - 1], v) && v == (int) (N_THREADS * ROUNDS + 1));
+
+    check("remove", table._remove(keys[0]) && !table._find(keys[0], v) &&
+                    table.get_number_OF_items() == N_KEYS - 1);
+}
+
+
+//Freeze a HashTable with n keys and search all of them, and n keys that are not in the table
+template <typename Hasher>
+bool check_frozen_table(unsigned n)
+{
+    HashTable<string, int, Hasher> T(7);
+
+    for (unsigned i = 0; i < n; ++i)
+        T._insert("key" + to_string(i), i);
+
+    Frozen_Table<string, int, Hasher> F(T);
+    bool ok = (F.get_number_OF_items() == n);
+
+    for (unsigned i = 0; i < n && ok; ++i)
+    {
+        const int* p = F._find("key" + to_string(i));
+
+        ok = p && *p == (int) i && !F._find("absent" + to_string(i));
+    }
+
+    return ok;
+}
+
+
+//Table sizes that are powers of two, and keys with the same hash value (my_hash), which go to the overflow array
+void test_frozen_table()
+{
+    for (unsigned n : { 0u, 1u, 1000u, 1023u, 1024u, 4096u })
+        check("freeze " + to_string(n) + " keys", check_frozen_table<wy_hash>(n));
+
+    check("freeze 1000 keys, many with the same hash value", check_frozen_table<my_hash>(1000));
+}
+
+
+//Static_Table built by the compiler: the test fails to compile if a search is wrong
+constexpr auto KEYWORDS = make_static_table<string_view, int>({ { "if", 1 }, { "else", 2 }, { "while", 3 },
+                                                                 { "for", 4 }, { "return", 5 } });
+
+static_assert(KEYWORDS.get_number_OF_items() == 5 && *KEYWORDS._find("if") == 1 &&
+              *KEYWORDS._find("return") == 5 && !KEYWORDS.contains("do"));
+
+
+//Build a Static_Table with N integer keys at run time and search all of them, and N keys that are not in the table
+template <size_t N>
+bool check_static_table()
+{
+    static Static_Item<int, int> items[N];
+
+    for (size_t i = 0; i < N; ++i)
+        items[i] = { (int) (7 * i), (int) i };
+
+    static const Static_Table<int, int, N> T(items);
+    bool ok = true;
+
+    for (size_t i = 0; i < N && ok; ++i)
+        ok = T._find((int) (7 * i)) && *T._find((int) (7 * i)) == (int) i && !T.contains((int) (7 * i + 1));
+
+    return ok;
+}
+
+
+//Table sizes that are powers of two, and string keys searched with string and const char*
+void test_static_table()
+{
+    check("keywords", KEYWORDS.contains(string("while")) && *KEYWORDS._find("else") == 2 &&
+                      !KEYWORDS._find(string("iff")));
+
+    check("1000 keys", check_static_table<1000>());
+    check("1024 keys", check_static_table<1024>());
+    check("4096 keys", check_static_table<4096>());
+    check("65536 keys", check_static_table<65536>());
+}
+
+
+//Return true if table T and the reference R store the same items
+template <typename Table>
+bool same_items(const Table& T, const unordered_map<uint64_t, int>& R)
+{
+    unsigned n = 0;
+    bool ok = true;
+
+    T.for_each([&](uint64_t key, int v)
+    {
+        auto it = R.find(key);
+
+        ok = ok && it != R.end() && it->second == v;
+        ++n;
+    });
+
+    return ok && n == R.size() && T.get_number_OF_items() == R.size();
+}
+
+
+//Random inserts, removals, and increments of integer keys, compared with unordered_map
+//The keys are drawn from a small range, so that clusters are often shifted back by the removals,
+//and EMPTY_KEY, the key stored apart from the arrays, is one of them
+void test_int_table()
+{
+    typedef HashTable<uint64_t, int, int_hash> Int_Table;
+
+    const unsigned N_OPS = 200000;
+    const uint64_t N_KEYS = 5000;
+
+    Int_Table T(7);
+    unordered_map<uint64_t, int> R;
+    mt19937_64 rnd(2024);
+    bool ok = true;
+
+    for (unsigned i = 0; i < N_OPS && ok; ++i)
+    {
+        uint64_t key = rnd() % (N_KEYS + 1);
+
+        if (key == N_KEYS)
+            key = Int_Table::EMPTY_KEY;
+
+        switch (rnd() % 4)
+        {
+            case 0:
+                T._insert(key, i);
+                R[key] = i;
+                break;
+
+            case 1:
+                ok = (T._remove(key) == (R.erase(key) == 1));
+                break;
+
+            case 2:
+                ++T[key];
+                ++R[key];
+                break;
+
+            default:
+            {
+                const int* p = T._find(key);
+                auto it = R.find(key);
+
+                ok = (it == R.end()) ? !p : (p && *p == it->second);
+            }
+        }
+    }
+
+    check("random inserts, removals, and increments", ok && same_items(T, R));
+    check("EMPTY_KEY item", (T._find(Int_Table::EMPTY_KEY) != nullptr) == (R.count(Int_Table::EMPTY_KEY) == 1));
+
+    vector<uint64_t> keys;
+
+    for (uint64_t k = 0; k < 2 * N_KEYS; k += 3)
+        keys.push_back(k);
+
+    keys.push_back(Int_Table::EMPTY_KEY);
+
+    T.increment_many(&keys[0], keys.size());
+
+    for (uint64_t k : keys)
+        ++R[k];
+
+    check("increment_many", same_items(T, R));
+
+    Table_Shape S = T.analyze();
+
+    check("analyze", S.items == T.get_number_OF_items() - R.count(Int_Table::EMPTY_KEY) &&
+                     (sizeof(size_t) < 8 || S.equal_hashes == 0));
+
+    T.reserve(8 * R.size());
+    check("reserve", same_items(T, R) && T.get_size() >= 8 * R.size());
+
+    for (uint64_t k = 0; k < 2 * N_KEYS; ++k)
+    {
+        T._remove(k);
+        R.erase(k);
+    }
+
+    unsigned size = T.get_size();
+
+    T.shrink_to_fit();
+    check("shrink_to_fit", same_items(T, R) && T.get_size() < size && T.get_number_OF_items() == 1);
+}
+
+
+//Return true if tables T and F give the same answer to _find and find_many for the keys "key0" to "key<n-1>"
+template <typename Table>
+bool same_answers(Table& T, Table& F, unsigned n)
+{
+    vector<string> keys;
+    bool ok = (T.get_number_OF_items() == F.get_number_OF_items());
+
+    for (unsigned i = 0; i < n && ok; ++i)
+    {
+        const int* p = T._find("key" + to_string(i));
+        const int* q = F._find("key" + to_string(i));
+
+        ok = (p == nullptr) == (q == nullptr) && (!p || *p == *q);
+        keys.push_back("key" + to_string(i));
+    }
+
+    vector<const int*> p(n), q(n);
+
+    T.find_many(keys.data(), n, p.data());
+    F.find_many(keys.data(), n, q.data());
+
+    for (unsigned i = 0; i < n && ok; ++i)
+        ok = (p[i] == nullptr) == (q[i] == nullptr) && (!p[i] || *p[i] == *q[i]);
+
+    return ok;
+}
+
+
+//Compare a HashTable with and without a Bloom filter, before and after removals and re-hashes
+//Keys "key0" to "key<N-1>" are inserted, the other searched keys are absent and most of them must be rejected by the filter
+void test_table_filter()
+{
+    const unsigned N = 5000;
+
+    HashTable<string, int> T(7), F(7);
+
+    F.enable_filter();
+
+    for (unsigned i = 0; i < N; ++i)
+    {
+        T._insert("key" + to_string(i), i);
+        F._insert("key" + to_string(i), i);
+    }
+
+    check("searches", same_answers(T, F, 2 * N));
+    check("absent keys rejected by the filter", F.get_filter()->get_stats().rejected > 0);
+
+    bool ok = true;
+
+    for (unsigned i = 0; i < 2 * N; i += 2)
+        ok = ok && (T._remove("key" + to_string(i)) == F._remove("key" + to_string(i)));
+
+    check("searches after removals", ok && same_answers(T, F, 2 * N));
+
+    T.reserve(4 * N);
+    F.reserve(4 * N);
+    check("searches after a re-hash", same_answers(T, F, 2 * N));
+
+    F.disable_filter();
+    check("searches after the filter is removed", same_answers(T, F, 2 * N) && !F.get_filter());
+}
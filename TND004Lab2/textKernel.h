@@ -0,0 +1,301 @@
+/*
+  Course: TND004, Lab 2
+  Description: character classification and normalization kernels used by the Tokenizer
+              Text is classified 32 bytes at a time with AVX2 (if compiled with -mavx2) or SSE2,
+              and with a lookup table on other processors
+*/
+
+#ifndef TEXTKERNEL_H_INCLUDED
+#define TEXTKERNEL_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TEXT_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXT_KERNEL_SSE2
+#endif
+
+using namespace std;
+
+
+//Punctuation characters removed from the words
+constexpr char PUNCT[] = ".,!?:\"();";
+
+
+//Character classes, as bits of Char_Table::c
+const unsigned char CC_SPACE = 1;  //separates words, as for operator>> in the "C" locale
+const unsigned char CC_PUNCT = 2;  //removed from words
+const unsigned char CC_UPPER = 4;  //transformed to lower-case
+
+
+//Lookup table with the class of each char
+//A char with class 0 is copied unchanged to a word
+struct Char_Table
+{
+    unsigned char c[256];
+
+    constexpr Char_Table()
+        : c()
+    {
+        for (const char* p = " \n\t\r\v\f"; *p; ++p)
+            c[(unsigned char) *p] |= CC_SPACE;
+
+        for (const char* p = PUNCT; *p; ++p)
+            c[(unsigned char) *p] |= CC_PUNCT;
+
+        for (int i = 'A'; i <= 'Z'; ++i)
+            c[i] |= CC_UPPER;
+    }
+
+    unsigned char operator[](char x) const
+    {
+        return c[(unsigned char) x];
+    }
+};
+
+constexpr Char_Table CHAR_CLASS;
+
+
+//Number of bytes classified by classify()
+const size_t KERNEL_WIDTH = 32;
+
+
+//Masks of the KERNEL_WIDTH bytes starting at p
+//Bit i is set if byte p[i] is in the class
+struct Char_Masks
+{
+    uint32_t space;  //CC_SPACE
+    uint32_t punct;  //CC_PUNCT
+    uint32_t upper;  //CC_UPPER
+};
+
+
+//Return the position of the lowest bit set in m, m != 0
+inline unsigned lowest_bit(uint32_t m)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(m);
+#else
+    unsigned i = 0;
+
+    for (; !(m & 1); m >>= 1)
+        ++i;
+
+    return i;
+#endif
+}
+
+
+#if defined(TEXT_KERNEL_AVX2)
+
+inline Char_Masks classify(const char* p)
+{
+    const __m256i v = _mm256_loadu_si256((const __m256i*) p);
+
+    //'\t' to '\r' are consecutive
+    __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                    _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)),
+                                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v)));
+
+    __m256i punct = _mm256_setzero_si256();
+
+    for (const char* c = PUNCT; *c; ++c)
+        punct = _mm256_or_si256(punct, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(*c)));
+
+    //bytes >= 0x80 are negative, thus not upper-case
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+
+    return Char_Masks { (uint32_t) _mm256_movemask_epi8(space),
+                        (uint32_t) _mm256_movemask_epi8(punct),
+                        (uint32_t) _mm256_movemask_epi8(upper) };
+}
+
+
+//Copy KERNEL_WIDTH bytes from src to dst, with upper-case letters transformed to lower-case
+inline void to_lower(const char* src, char* dst)
+{
+    const __m256i v = _mm256_loadu_si256((const __m256i*) src);
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+
+    _mm256_storeu_si256((__m256i*) dst, _mm256_add_epi8(v, _mm256_and_si256(upper, _mm256_set1_epi8('a' - 'A'))));
+}
+
+#elif defined(TEXT_KERNEL_SSE2)
+
+//Masks of the 16 bytes at p
+inline Char_Masks classify16(const char* p)
+{
+    const __m128i v = _mm_loadu_si128((const __m128i*) p);
+
+    //'\t' to '\r' are consecutive
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                 _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)),
+                                               _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1))));
+
+    __m128i punct = _mm_setzero_si128();
+
+    for (const char* c = PUNCT; *c; ++c)
+        punct = _mm_or_si128(punct, _mm_cmpeq_epi8(v, _mm_set1_epi8(*c)));
+
+    //bytes >= 0x80 are negative, thus not upper-case
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                  _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+
+    return Char_Masks { (uint32_t) _mm_movemask_epi8(space),
+                        (uint32_t) _mm_movemask_epi8(punct),
+                        (uint32_t) _mm_movemask_epi8(upper) };
+}
+
+inline Char_Masks classify(const char* p)
+{
+    Char_Masks lo = classify16(p);
+    Char_Masks hi = classify16(p + 16);
+
+    return Char_Masks { lo.space | (hi.space << 16), lo.punct | (hi.punct << 16), lo.upper | (hi.upper << 16) };
+}
+
+
+//Copy KERNEL_WIDTH bytes from src to dst, with upper-case letters transformed to lower-case
+inline void to_lower(const char* src, char* dst)
+{
+    for (int i = 0; i < 32; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A'))));
+    }
+}
+
+#else
+
+inline Char_Masks classify(const char* p)
+{
+    Char_Masks m = { 0, 0, 0 };
+
+    for (unsigned i = 0; i < KERNEL_WIDTH; ++i)
+    {
+        unsigned char cls = CHAR_CLASS[p[i]];
+
+        m.space |= (uint32_t) ((cls & CC_SPACE) != 0) << i;
+        m.punct |= (uint32_t) ((cls & CC_PUNCT) != 0) << i;
+        m.upper |= (uint32_t) ((cls & CC_UPPER) != 0) << i;
+    }
+
+    return m;
+}
+
+
+//Copy KERNEL_WIDTH bytes from src to dst, with upper-case letters transformed to lower-case
+inline void to_lower(const char* src, char* dst)
+{
+    for (unsigned i = 0; i < KERNEL_WIDTH; ++i)
+        dst[i] = (CHAR_CLASS[src[i]] & CC_UPPER) ? src[i] + ('a' - 'A') : src[i];
+}
+
+#endif
+
+
+/* ********************************** *
+* Kernels on ranges of text           *
+* *********************************** */
+
+//Return a pointer to the first char in [p, last) that is not a space, or last
+inline const char* skip_spaces(const char* p, const char* last)
+{
+    for (; last - p >= (ptrdiff_t) KERNEL_WIDTH; p += KERNEL_WIDTH)
+    {
+        uint32_t not_space = ~classify(p).space;
+
+        if (not_space)
+            return p + lowest_bit(not_space);
+    }
+
+    while (p != last && (CHAR_CLASS[*p] & CC_SPACE))
+        ++p;
+
+    return p;
+}
+
+
+//Return a pointer to the first space in [p, last), or last
+//dirty is set to true if some char before it must be normalized (punctuation or upper-case)
+inline const char* find_word_end(const char* p, const char* last, bool& dirty)
+{
+    uint32_t d = 0;
+
+    for (; last - p >= (ptrdiff_t) KERNEL_WIDTH; p += KERNEL_WIDTH)
+    {
+        Char_Masks m = classify(p);
+
+        if (m.space)
+        {
+            unsigned n = lowest_bit(m.space);
+
+            d |= (m.punct | m.upper) & ((1u << n) - 1);  //n < 32
+            dirty = d != 0;
+
+            return p + n;
+        }
+
+        d |= m.punct | m.upper;
+    }
+
+    unsigned char cls = 0;
+
+    for (; p != last && !((cls = CHAR_CLASS[*p]) & CC_SPACE); ++p)
+        d |= cls;
+
+    dirty = d != 0;
+
+    return p;
+}
+
+
+//Normalize the word [w, e): copy it to dst with upper-case letters transformed to lower-case
+//and punctuation removed
+//Return the length of the normalized word, dst must have room for e - w chars
+inline size_t normalize_word(const char* w, const char* e, char* dst)
+{
+    char* q = dst;
+
+    for (; e - w >= (ptrdiff_t) KERNEL_WIDTH; w += KERNEL_WIDTH)
+    {
+        uint32_t punct = classify(w).punct;
+
+        if (!punct)
+        {
+            to_lower(w, q);
+            q += KERNEL_WIDTH;
+            continue;
+        }
+
+        for (unsigned i = 0; i < KERNEL_WIDTH; ++i)
+        {
+            if (!(punct & (1u << i)))
+                *q++ = (CHAR_CLASS[w[i]] & CC_UPPER) ? w[i] + ('a' - 'A') : w[i];
+        }
+    }
+
+    for (; w != e; ++w)
+    {
+        unsigned char cls = CHAR_CLASS[*w];
+
+        if (cls & CC_PUNCT)
+            continue;
+
+        *q++ = (cls & CC_UPPER) ? *w + ('a' - 'A') : *w;
+    }
+
+    return q - dst;
+}
+
+#endif // TEXTKERNEL_H_INCLUDED
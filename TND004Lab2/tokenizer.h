@@ -0,0 +1,89 @@
+/*
+  Course: TND004, Lab 2
+  Description: class Tokenizer splits a text into normalized words in a single pass
+              Words are lower-cased and the characters in PUNCT are removed
+*/
+
+#ifndef TOKENIZER_H_INCLUDED
+#define TOKENIZER_H_INCLUDED
+
+#include "textKernel.h"
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+
+//Class to split the text [begin, end) in normalized words, without copying the text
+//A word that needs no normalization is returned as a view of the text
+//Other words are normalized into a scratch buffer owned by the tokenizer
+class Tokenizer
+{
+public:
+
+    //Initial size of the scratch buffer, grown if a single word does not fit
+    static constexpr size_t SCRATCH_SIZE = 64 * 1024;
+
+    Tokenizer(const char* begin, const char* end)
+        : p(begin), last(end), scratch(SCRATCH_SIZE) { }
+
+    //Store the next (at most) n words of the text in tokens
+    //Return the number of words stored, 0 when the end of the text is reached
+    //The views are valid until the next call
+    unsigned next_block(string_view tokens[], unsigned n);
+
+private:
+
+    const char* p;     //next char to read
+    const char* last;  //end of the text
+    vector<char> scratch;
+};
+
+
+//The text is classified KERNEL_WIDTH bytes at a time (see textKernel.h)
+inline unsigned Tokenizer::next_block(string_view tokens[], unsigned n)
+{
+    size_t used = 0;  //bytes of scratch used by this block
+    unsigned k = 0;
+
+    while (k < n)
+    {
+        p = skip_spaces(p, last);
+
+        if (p == last)
+            break;
+
+        const char* w = p;
+        bool dirty;
+        const char* e = find_word_end(p, last, dirty);
+
+        //most words need no normalization
+        if (!dirty)
+        {
+            tokens[k++] = string_view(w, e - w);
+            p = e;
+            continue;
+        }
+
+        //the normalized word is at most as long as the original one
+        if (used + (e - w) > scratch.size())
+        {
+            if (k > 0)
+                break;  //return this block, the word is read again by the next call
+
+            scratch.resize(e - w);
+        }
+
+        size_t len = normalize_word(w, e, &scratch[used]);
+
+        tokens[k++] = string_view(&scratch[used], len);
+        used += len;
+        p = e;
+    }
+
+    return k;
+}
+
+#endif // TOKENIZER_H_INCLUDED
@@ -0,0 +1,251 @@
+/*
+  Course: TND004, Lab 2
+  Description: word frequency counting used by the driver in main.cpp
+              The text is split into chunks on word boundaries, each chunk is counted by a thread
+              into its own HashTable and the tables are merged at the end (map-reduce),
+              or all threads count into one Concurrent_HashTable
+*/
+
+#ifndef WORDCOUNT_H_INCLUDED
+#define WORDCOUNT_H_INCLUDED
+
+#include "hashTable.h"
+#include "concurrentHashTable.h"
+#include "hashers.h"
+#include "tokenizer.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <cstdio>
+
+using namespace std;
+
+
+//Number of words counted together with HashTable::increment_many
+const unsigned BLOCK = 1024;
+
+//Number of bytes read at a time by count_stream
+const size_t STREAM_CHUNK = 1 << 20;
+
+
+//Instrumentation of the tables of word frequencies
+//Compile with -DTABLE_STATS to record their probe lengths and re-hash durations (see tableStats.h)
+#ifdef TABLE_STATS
+typedef Probe_Stats Freq_Stats;
+#else
+typedef No_Stats Freq_Stats;
+#endif
+
+//Table of word frequencies resolving collisions with the policy Probing (see probing.h)
+template <typename Probing = Linear_Probing>
+using Word_Table = HashTable<string, int, wy_hash, equal_to<>, Freq_Stats, Probing>;
+
+//Table of word frequencies with linear probing
+typedef Word_Table<> Freq_Table;
+
+//Table of word frequencies shared by several threads (see concurrentHashTable.h)
+typedef Concurrent_HashTable<string, int, wy_hash, equal_to<> > Shared_Freq_Table;
+
+
+//Statistics of a counting pass
+struct Count_Stats
+{
+    unsigned long words = 0;          //number of words counted
+    unsigned long visited_slots = 0;  //slots visited by all the tables used for counting
+
+    Count_Stats& operator+=(const Count_Stats& s)
+    {
+        words += s.words;
+        visited_slots += s.visited_slots;
+        return *this;
+    }
+};
+
+
+//Count the words in the text [begin, end) and add them to table
+//A word is a sequence of non-space characters, upper-case letters are transformed to lower-case
+//and the characters in PUNCT are removed (see Tokenizer)
+//Table is a Freq_Table or any table with the member functions increment_many and get_total_visited_slots,
+//e.g. Heavy_Hitters (see sketch.h)
+template <typename Table>
+Count_Stats count_words(const char* begin, const char* end, Table& table)
+{
+    Count_Stats stats;
+    Tokenizer words(begin, end);
+    string_view tokens[BLOCK];
+    unsigned long visited_before = table.get_total_visited_slots();
+
+    while (unsigned n = words.next_block(tokens, BLOCK))
+    {
+        table.increment_many(tokens, n);
+        stats.words += n;
+    }
+
+    stats.visited_slots = table.get_total_visited_slots() - visited_before;
+
+    return stats;
+}
+
+
+//Split the text [begin, end) in n chunks of about the same size, on word boundaries
+//Chunk i is [bounds[i], bounds[i+1]), the returned vector is bounds
+inline vector<const char*> split_text(const char* begin, const char* end, unsigned n)
+{
+    vector<const char*> bounds(n + 1, end);
+    bounds[0] = begin;
+
+    for (unsigned i = 1; i < n; ++i)
+    {
+        const char* b = max(bounds[i - 1], begin + (end - begin) / n * i);
+
+        while (b != end && !(CHAR_CLASS[*b] & CC_SPACE))
+            ++b;
+
+        bounds[i] = b;
+    }
+
+    return bounds;
+}
+
+
+//Count the words in the text [begin, end) with n_threads threads and add them to table
+//The text is split into n_threads chunks of about the same size, on word boundaries
+//Each thread counts its chunk into a local table, which are then merged into table
+template <typename Probing>
+Count_Stats count_words_parallel(const char* begin, const char* end, unsigned n_threads, Word_Table<Probing>& table)
+{
+    if (n_threads <= 1)
+        return count_words(begin, end, table);
+
+    vector<const char*> bounds = split_text(begin, end, n_threads);
+    vector<unique_ptr<Word_Table<Probing> > > tables;
+    vector<Count_Stats> stats(n_threads);
+    vector<thread> workers;
+
+    for (unsigned i = 0; i < n_threads; ++i)
+    {
+        tables.emplace_back(new Word_Table<Probing>(100));
+        tables[i]->set_max_load_factor(table.get_max_load_factor());
+    }
+
+    for (unsigned i = 0; i < n_threads; ++i)
+    {
+        workers.emplace_back([&, i]()
+        {
+            stats[i] = count_words(bounds[i], bounds[i + 1], *tables[i]);
+        });
+    }
+
+    for (thread& t : workers)
+        t.join();
+
+    Count_Stats total;
+    unsigned long visited_before = table.get_total_visited_slots();
+    unsigned largest = table.get_number_OF_items();
+
+    //the merged table has at least as many words as the largest table
+    for (unsigned i = 0; i < n_threads; ++i)
+        largest = max(largest, tables[i]->get_number_OF_items());
+
+    table.reserve(largest);
+
+    for (unsigned i = 0; i < n_threads; ++i)
+    {
+        table.merge(*tables[i]);
+        total += stats[i];
+    }
+
+    total.visited_slots += table.get_total_visited_slots() - visited_before;
+
+    return total;
+}
+
+
+//Count the words in the text [begin, end) with n_threads threads and add them to the shared table
+//The text is split as by count_words_parallel, but all threads count into table, thus there is nothing to merge
+//Each block of BLOCK words locks every shard at most once (see Concurrent_HashTable::increment_many)
+inline Count_Stats count_words_shared(const char* begin, const char* end, unsigned n_threads, Shared_Freq_Table& table)
+{
+    vector<const char*> bounds = split_text(begin, end, max(1u, n_threads));
+    vector<Count_Stats> stats(bounds.size() - 1);
+    vector<thread> workers;
+    unsigned long visited_before = table.get_total_visited_slots();
+
+    for (unsigned i = 0; i < stats.size(); ++i)
+    {
+        workers.emplace_back([&, i]()
+        {
+            stats[i] = count_words(bounds[i], bounds[i + 1], table);
+        });
+    }
+
+    for (thread& t : workers)
+        t.join();
+
+    //the slots visited by one thread cannot be told apart from the other threads' ones
+    Count_Stats total;
+
+    for (const Count_Stats& s : stats)
+        total.words += s.words;
+
+    total.visited_slots = table.get_total_visited_slots() - visited_before;
+
+    return total;
+}
+
+
+//Count the words read from stream f
+//The stream is read in chunks of STREAM_CHUNK bytes, a word cut at the end of a chunk is
+//moved to the next one, thus the memory used for the text is STREAM_CHUNK bytes
+//(or the length of the longest word, if larger)
+//f does not need to be seekable, e.g. it can be stdin or a pipe
+//Each chunk [b, e) is counted by calling count(b, e), e.g. count_words_parallel, which returns its Count_Stats
+//After each chunk, report(stats) is called with the statistics so far
+template <typename Count_Function, typename Function>
+Count_Stats count_stream(FILE* f, Count_Function count, Function report)
+{
+    Count_Stats total;
+    vector<char> buffer(STREAM_CHUNK);
+    size_t filled = 0;  //bytes in buffer
+    bool eof = false;
+
+    while (!eof)
+    {
+        //a single word fills the buffer
+        if (filled == buffer.size())
+            buffer.resize(2 * buffer.size());
+
+        size_t n = fread(&buffer[filled], 1, buffer.size() - filled, f);
+
+        eof = (filled + n < buffer.size());
+        filled += n;
+
+        const char* begin = buffer.data();
+        const char* end = begin + filled;
+        const char* cut = end;
+
+        //the last word may continue in the next chunk
+        if (!eof)
+        {
+            while (cut != begin && !(CHAR_CLASS[cut[-1]] & CC_SPACE))
+                --cut;
+        }
+
+        if (cut == begin && !eof)
+            continue;
+
+        total += count(begin, cut);
+
+        filled = end - cut;
+        copy(cut, end, buffer.begin());
+
+        report(total);
+    }
+
+    return total;
+}
+
+#endif // WORDCOUNT_H_INCLUDED